@@ -110,6 +110,316 @@ bool CheckCommand(const char* fmt, ...)
 	return false;
 }
 
+long long DeleteKeys(RedisConnect& redis, const char* host, int port, const char* passwd, const char* pattern, int batch, int threads)
+{
+	mutex mtx;
+	bool finished = false;
+	vector<string> vec;
+	vector<thread> workers;
+	condition_variable cond;
+	deque<vector<string>> queue;
+
+	long long scanned = 0;
+	atomic<long long> failed(0);
+	atomic<long long> deleted(0);
+
+	auto start = chrono::steady_clock::now();
+	auto utime = start;
+
+	auto progress = [&](){
+		double sec = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+		printf("\r已扫描[%lld] 已删除[%lld] 失败[%lld] 耗时[%.1fs] 速度[%.0f个/秒]", scanned, deleted.load(), failed.load(), sec, sec > 0 ? deleted.load() / sec : 0.0);
+		fflush(stdout);
+	};
+
+	auto submit = [&](){
+		unique_lock<mutex> lk(mtx);
+
+		cond.wait(lk, [&](){ return (int)(queue.size()) < threads * 2; });
+
+		queue.push_back(std::move(vec));
+		cond.notify_all();
+
+		vec.clear();
+	};
+
+	for (int i = 0; i < threads; i++)
+	{
+		workers.push_back(thread([&](){
+			RedisConnect conn;
+			const char* name = "unlink";
+			bool ready = conn.connect(host, port, 3) && (passwd == NULL || *passwd == 0 || conn.auth(passwd) > 0);
+
+			while (true)
+			{
+				vector<string> keys;
+
+				{
+					unique_lock<mutex> lk(mtx);
+
+					cond.wait(lk, [&](){ return finished || queue.size() > 0; });
+
+					if (queue.empty()) return;
+
+					keys.swap(queue.front());
+					queue.pop_front();
+					cond.notify_all();
+				}
+
+				RedisConnect::Command cmd;
+
+				auto execute = [&](){
+					cmd.clear();
+					cmd.add(name);
+
+					for (const string& key : keys) cmd.add(key);
+
+					return conn.execute(cmd);
+				};
+
+				int res = ready ? execute() : RedisConnect::NETERR;
+
+				if (res == RedisConnect::FAIL && strcmp(name, "unlink") == 0)
+				{
+					name = "del";
+					res = execute();
+				}
+				else if (res < 0 && res != RedisConnect::FAIL && (ready = conn.reconnect()))
+				{
+					res = execute();
+				}
+
+				if (res > 0)
+				{
+					deleted += conn.getStatus();
+				}
+				else
+				{
+					failed += keys.size();
+				}
+			}
+		}));
+	}
+
+	int res = redis.scan([&](const RedisConnect::View& key){
+		vec.push_back(key.toString());
+
+		if ((int)(vec.size()) >= batch) submit();
+
+		if (++scanned % batch == 0 && chrono::steady_clock::now() - utime > chrono::seconds(1))
+		{
+			utime = chrono::steady_clock::now();
+			progress();
+		}
+
+		return true;
+	}, pattern, batch);
+
+	if (vec.size() > 0) submit();
+
+	{
+		lock_guard<mutex> lk(mtx);
+
+		finished = true;
+		cond.notify_all();
+	}
+
+	for (thread& item : workers) item.join();
+
+	progress();
+	printf("\n");
+
+	if (res < 0)
+	{
+		ColorPrint(eRED, "扫描键值失败[%d][%s]\n", res, redis.getErrorString().c_str());
+	}
+
+	return deleted.load();
+}
+
+bool ReadLine(FILE* fp, string& line)
+{
+	int ch;
+
+	line.clear();
+
+	while ((ch = getc(fp)) != EOF)
+	{
+		if (ch == '\n')
+		{
+			if (line.size() > 0 && line.back() == '\r') line.pop_back();
+
+			return true;
+		}
+
+		line.push_back((char)(ch));
+	}
+
+	return line.size() > 0;
+}
+
+int ReadCommand(FILE* fp, string& line, string& val, RedisConnect::Command& cmd)
+{
+	while (ReadLine(fp, line))
+	{
+		if (line.empty()) continue;
+
+		if (line[0] == '*')
+		{
+			int cnt = atoi(line.c_str() + 1);
+
+			if (cnt <= 0) return RedisConnect::DATAERR;
+
+			for (int i = 0; i < cnt; i++)
+			{
+				if (!ReadLine(fp, line) || line.empty() || line[0] != '$') return RedisConnect::DATAERR;
+
+				int len = atoi(line.c_str() + 1);
+
+				if (len < 0) return RedisConnect::DATAERR;
+
+				val.resize(len);
+
+				if ((int)(fread(&val[0], 1, len, fp)) < len || getc(fp) != '\r' || getc(fp) != '\n') return RedisConnect::DATAERR;
+
+				cmd.add(val);
+			}
+
+			return RedisConnect::OK;
+		}
+
+		int argc = 0;
+		const char* str = line.c_str();
+
+		while (true)
+		{
+			while (isspace((unsigned char)(*str))) str++;
+
+			if (*str == 0) break;
+
+			val.clear();
+
+			if (*str == '"' || *str == '\'')
+			{
+				char quote = *str++;
+
+				while (*str && *str != quote)
+				{
+					if (*str == '\\' && quote == '"' && str[1]) str++;
+
+					val.push_back(*str++);
+				}
+
+				if (*str) str++;
+			}
+			else
+			{
+				while (*str && !isspace((unsigned char)(*str))) val.push_back(*str++);
+			}
+
+			cmd.add(val);
+			argc++;
+		}
+
+		if (argc > 0) return RedisConnect::OK;
+	}
+
+	return RedisConnect::NOTFOUND;
+}
+
+long long PipeCommands(const char* host, int port, const char* passwd, FILE* fp, int window)
+{
+	mutex mtx;
+	string line;
+	string val;
+	string error;
+	condition_variable cond;
+
+	long long sent = 0;
+	long long failed = 0;
+	long long replied = 0;
+
+	auto start = chrono::steady_clock::now();
+	auto utime = start;
+
+	auto progress = [&](){
+		double sec = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+		lock_guard<mutex> lk(mtx);
+
+		printf("\r已发送[%lld] 已应答[%lld] 失败[%lld] 耗时[%.1fs] 速度[%.0f条/秒]", sent, replied, failed, sec, sec > 0 ? replied / sec : 0.0);
+		fflush(stdout);
+	};
+
+	RedisConnect::Multiplexer mux;
+
+	if (!mux.connect(host, port, passwd ? passwd : ""))
+	{
+		ColorPrint(eRED, "REDIS[%s][%d]连接失败\n", host, port);
+
+		return -1;
+	}
+
+	auto callback = [&](RedisConnect::Command& reply){
+		lock_guard<mutex> lk(mtx);
+
+		if (reply.getErrorCode() < 0)
+		{
+			if (failed++ == 0) error = reply.getErrorString();
+		}
+
+		replied++;
+		cond.notify_one();
+	};
+
+	int res = 0;
+
+	while (true)
+	{
+		shared_ptr<RedisConnect::Command> cmd = make_shared<RedisConnect::Command>();
+
+		if ((res = ReadCommand(fp, line, val, *cmd)) != RedisConnect::OK) break;
+
+		{
+			unique_lock<mutex> lk(mtx);
+
+			cond.wait(lk, [&](){ return sent - replied < window; });
+
+			sent++;
+		}
+
+		mux.submit(cmd, callback);
+
+		if (sent % window == 0 && chrono::steady_clock::now() - utime > chrono::seconds(1))
+		{
+			utime = chrono::steady_clock::now();
+			progress();
+		}
+	}
+
+	{
+		unique_lock<mutex> lk(mtx);
+
+		cond.wait(lk, [&](){ return replied >= sent; });
+	}
+
+	progress();
+	printf("\n");
+
+	if (res == RedisConnect::DATAERR)
+	{
+		ColorPrint(eRED, "解析第%lld条命令失败\n", sent + 1);
+	}
+
+	if (failed > 0)
+	{
+		ColorPrint(eRED, "首个错误应答[%s]\n", error.c_str());
+	}
+
+	return replied - failed;
+}
+
 int main(int argc, char** argv)
 {
 	auto GetCmdParam = [&](int idx){
@@ -165,32 +475,53 @@ int main(int argc, char** argv)
 
 		if (tmp == "DELS" && key && *key)
 		{
-			vector<string> vec;
+			int batch = field ? atoi(field) : 1000;
+			int threads = GetCmdParam(4) ? atoi(GetCmdParam(4)) : 1;
 
-			if (redis.keys(vec, key) > 0)
+			if (batch <= 0) batch = 1000;
+			if (threads <= 0) threads = 1;
+
+			if (CheckCommand("确认要删除键值[%s]？", key))
 			{
-				if (CheckCommand("确认要删除键值[%s]？", key))
-				{
-					ColorPrint(eWHITE, "%s\n", "--------------------------------------");
+#ifndef _MSC_VER
+				signal(SIGPIPE, SIG_IGN);
+#endif
+				ColorPrint(eWHITE, "%s\n", "--------------------------------------");
 
-					for (const string& item : vec)
-					{
-						if (redis.del(item))
-						{
-							ColorPrint(eGREEN, "删除键值[%s]成功\n", item.c_str());
-						}
-						else
-						{
-							ColorPrint(eRED, "删除键值[%s]失败\n", item.c_str());
-						}
-					}
+				long long cnt = DeleteKeys(redis, host, port, passwd, key, batch, threads);
 
-					ColorPrint(eWHITE, "%s\n\n", "--------------------------------------");
-				}
+				ColorPrint(eWHITE, "%s\n", "--------------------------------------");
+				ColorPrint(eGREEN, "共删除%lld个键值\n\n", cnt);
 			}
-			else
+		}
+		else if (tmp == "--PIPE")
+		{
+			FILE* fp = stdin;
+			int window = field ? atoi(field) : 10000;
+
+			if (window <= 0) window = 10000;
+
+			if (key && *key && strcmp(key, "-") && (fp = fopen(key, "rb")) == NULL)
+			{
+				ColorPrint(eRED, "打开文件[%s]失败\n", key);
+
+				return -1;
+			}
+
+#ifndef _MSC_VER
+			signal(SIGPIPE, SIG_IGN);
+#endif
+			ColorPrint(eWHITE, "%s\n", "--------------------------------------");
+
+			long long cnt = PipeCommands(host, port, passwd, fp, window);
+
+			if (fp != stdin) fclose(fp);
+
+			ColorPrint(eWHITE, "%s\n", "--------------------------------------");
+
+			if (cnt >= 0)
 			{
-				ColorPrint(eRED, "删除键值[%s]失败\n", key);
+				ColorPrint(eGREEN, "共成功执行%lld条命令\n\n", cnt);
 			}
 		}
 		else
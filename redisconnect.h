@@ -2,22 +2,46 @@
 #define REDIS_CONNECT_H
 ///////////////////////////////////////////////////////////////
 #include <map>
+#include <list>
+#include <deque>
 #include <mutex>
+#include <future>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <climits>
 #include <memory>
 #include <vector>
 #include <string>
 #include <sstream>
 #include <cstring>
+#include <algorithm>
+#include <functional>
+#include <type_traits>
+#include <unordered_map>
+#include <condition_variable>
 
 #ifdef _MSC_VER
 
 #include <conio.h>
+#include <winsock2.h>
 #include <windows.h>
 
 #pragma comment(lib, "WS2_32.lib")
 
+#define poll WSAPoll
+
+typedef int socklen_t;
+
+struct iovec
+{
+	void* iov_base;
+	size_t iov_len;
+};
+
 #else
 
+#include <poll.h>
 #include <errno.h>
 #include <netdb.h>
 #include <fcntl.h>
@@ -27,6 +51,7 @@
 #include <sys/wait.h>
 #include <sys/stat.h>
 #include <sys/file.h>
+#include <sys/uio.h>
 #include <sys/types.h>
 #include <sys/ioctl.h>
 #include <arpa/inet.h>
@@ -38,6 +63,31 @@
 #define ioctlsocket ioctl
 #define INVALID_SOCKET (SOCKET)(-1)
 
+#ifndef IOV_MAX
+#define IOV_MAX 1024
+#endif
+
+#if defined(__cpp_impl_coroutine) && __cplusplus >= 202002L
+
+#include <coroutine>
+#include <sys/eventfd.h>
+
+#define REDIS_CONNECT_COROUTINE
+
+#endif
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+
+#define REDIS_CONNECT_URING
+
+#endif
+#endif
+
 typedef int SOCKET;
 
 #endif
@@ -67,20 +117,375 @@ public:
 	static const int AUTHFAIL = -12;
 	static const int POOL_MAXLEN = 8;
 	static const int SOCKET_TIMEOUT = 10;
+	static const int BUFFER_MINSZ = 4 * 1024;
+	static const int BUFFER_MAXSZ = 64 * 1024 * 1024;
+	static const int INPLACE_MINSZ = 16 * 1024;
+	static const int URING_ENTRIES = 8;
+	static const int CLUSTER_SLOTS = 16384;
+	static const int CLUSTER_REDIRECT = 5;
+	static const int CLUSTER_REFRESH = 1000;
+	static const int SHARD_POINTS = 160;
+	static const int REPLICA_EWMA = 8;
+	static const int REPLICA_REFRESH = 1000;
+	static const int HEDGE_BURST = 10;
+	static const int HEDGE_MINCNT = 100;
+	static const int HEDGE_BUCKETS = 96;
+	static const int SUBSCRIBE_IDLE = 30 * 1000;
+	static const int SUBSCRIBE_BACKOFF = 100;
+	static const int SUBSCRIBE_BACKLOG = 256;
+	static const int NEARCACHE_SHARDS = 16;
+	static const int NEARCACHE_REFRESH = 1000;
+	static const int NEARCACHE_OVERHEAD = 64;
+	static const int SCAN_COUNT = 1000;
 
 public:
+#ifdef REDIS_CONNECT_URING
+	class Uring
+	{
+	protected:
+		int fd = -1;
+		int inflight = 0;
+		unsigned pending = 0;
+
+		size_t sqlen = 0;
+		size_t cqlen = 0;
+		size_t sqelen = 0;
+		char* sqmap = NULL;
+		char* cqmap = NULL;
+		struct io_uring_sqe* sqes = NULL;
+
+		unsigned* sqtail = NULL;
+		unsigned* sqmask = NULL;
+		unsigned* sqarray = NULL;
+		unsigned* cqhead = NULL;
+		unsigned* cqtail = NULL;
+		unsigned* cqmask = NULL;
+		struct io_uring_cqe* cqes = NULL;
+
+		int version = -1;
+		const void* fixed = NULL;
+
+		static void* Map(int fd, size_t len, long long offset)
+		{
+			void* addr = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, offset);
+
+			return addr == MAP_FAILED ? NULL : addr;
+		}
+
+	public:
+		Uring()
+		{
+		}
+		Uring(const Uring&) = delete;
+		Uring& operator = (const Uring&) = delete;
+		~Uring()
+		{
+			close();
+		}
+
+	public:
+		bool init(int entries)
+		{
+			struct io_uring_params params;
+
+			close();
+			memset(&params, 0, sizeof(params));
+
+			if ((fd = syscall(__NR_io_uring_setup, entries, &params)) < 0) return false;
+
+			if ((params.features & IORING_FEAT_EXT_ARG) == 0) return close();
+
+			sqlen = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+			cqlen = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+			sqelen = params.sq_entries * sizeof(struct io_uring_sqe);
+
+			if (params.features & IORING_FEAT_SINGLE_MMAP)
+			{
+				if (cqlen > sqlen) sqlen = cqlen;
+
+				cqlen = 0;
+			}
+
+			if ((sqmap = (char*)(Map(fd, sqlen, IORING_OFF_SQ_RING))) == NULL) return close();
+
+			if (cqlen == 0)
+			{
+				cqmap = sqmap;
+			}
+			else if ((cqmap = (char*)(Map(fd, cqlen, IORING_OFF_CQ_RING))) == NULL)
+			{
+				return close();
+			}
+
+			if ((sqes = (struct io_uring_sqe*)(Map(fd, sqelen, IORING_OFF_SQES))) == NULL) return close();
+
+			sqtail = (unsigned*)(sqmap + params.sq_off.tail);
+			sqmask = (unsigned*)(sqmap + params.sq_off.ring_mask);
+			sqarray = (unsigned*)(sqmap + params.sq_off.array);
+			cqhead = (unsigned*)(cqmap + params.cq_off.head);
+			cqtail = (unsigned*)(cqmap + params.cq_off.tail);
+			cqmask = (unsigned*)(cqmap + params.cq_off.ring_mask);
+			cqes = (struct io_uring_cqe*)(cqmap + params.cq_off.cqes);
+
+			return true;
+		}
+		bool close()
+		{
+			if (sqes) munmap(sqes, sqelen);
+
+			if (cqmap && cqmap != sqmap) munmap(cqmap, cqlen);
+
+			if (sqmap) munmap(sqmap, sqlen);
+
+			if (fd >= 0) ::close(fd);
+
+			fd = -1;
+			sqes = NULL;
+			sqmap = cqmap = NULL;
+			inflight = pending = 0;
+			fixed = NULL;
+			version = -1;
+
+			return false;
+		}
+		int getInflight() const
+		{
+			return inflight;
+		}
+		bool bind(const void* data, int size, int version)
+		{
+			struct iovec vec;
+
+			if (fixed == data && this->version == version) return true;
+
+			if (fixed) syscall(__NR_io_uring_register, fd, IORING_UNREGISTER_BUFFERS, NULL, 0);
+
+			vec.iov_base = (void*)(data);
+			vec.iov_len = size;
+			fixed = NULL;
+
+			if (syscall(__NR_io_uring_register, fd, IORING_REGISTER_BUFFERS, &vec, 1) < 0) return false;
+
+			this->version = version;
+			this->fixed = data;
+
+			return true;
+		}
+		struct io_uring_sqe* prepare(int opcode, int sock, const void* addr, unsigned len, unsigned long long data)
+		{
+			unsigned tail = *sqtail;
+			unsigned idx = tail & *sqmask;
+			struct io_uring_sqe* sqe = sqes + idx;
+
+			memset(sqe, 0, sizeof(*sqe));
+
+			sqe->fd = sock;
+			sqe->len = len;
+			sqe->opcode = opcode;
+			sqe->user_data = data;
+			sqe->addr = (unsigned long long)(addr);
+			sqarray[idx] = idx;
+
+			__atomic_store_n(sqtail, tail + 1, __ATOMIC_RELEASE);
+
+			pending++;
+			inflight++;
+
+			return sqe;
+		}
+		int enter(int wait, long long deadline)
+		{
+			struct __kernel_timespec ts;
+			struct io_uring_getevents_arg arg;
+
+			while (true)
+			{
+				long long ms = deadline - Socket::GetTime();
+
+				if (ms <= 0)
+				{
+					if (wait > 0) return TIMEOUT;
+
+					ms = 0;
+				}
+
+				memset(&arg, 0, sizeof(arg));
+
+				ts.tv_sec = ms / 1000;
+				ts.tv_nsec = ms % 1000 * 1000000;
+				arg.ts = (unsigned long long)(&ts);
+
+				int res = syscall(__NR_io_uring_enter, fd, pending, wait, IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG, &arg, sizeof(arg));
+
+				if (res >= 0)
+				{
+					pending -= res;
+
+					return OK;
+				}
+
+				if (errno == ETIME) return TIMEOUT;
+
+				if (errno != EINTR) return NETERR;
+			}
+		}
+		bool reap(unsigned long long& data, int& res)
+		{
+			unsigned head = *cqhead;
+
+			if (head == __atomic_load_n(cqtail, __ATOMIC_ACQUIRE)) return false;
+
+			struct io_uring_cqe* cqe = cqes + (head & *cqmask);
+
+			res = cqe->res;
+			data = cqe->user_data;
+
+			__atomic_store_n(cqhead, head + 1, __ATOMIC_RELEASE);
+
+			inflight--;
+
+			return true;
+		}
+		void drain()
+		{
+			int res = 0;
+			unsigned long long data = 0;
+
+			while (inflight > 0)
+			{
+				while (reap(data, res)) continue;
+
+				if (inflight > 0 && enter(1, Socket::GetTime() + 1000) < 0) break;
+			}
+		}
+	};
+#endif
+
+	class Buffer;
+
 	class Socket
 	{
 	protected:
 		SOCKET sock = INVALID_SOCKET;
 
+#ifdef REDIS_CONNECT_URING
+		int sendcnt = 0;
+		int sendlen = 0;
+		struct iovec* sendvec = NULL;
+		unique_ptr<Uring> ring;
+
+		void abort()
+		{
+			shutdown();
+			ring->drain();
+
+			if (ring->getInflight() > 0 && !ring->init(URING_ENTRIES)) ring.reset();
+
+			sendcnt = 0;
+		}
+		int submit(Buffer& buffer, int offset, long long deadline)
+		{
+			const unsigned long long SEND = 1;
+			const unsigned long long RECV = 2;
+
+			char* dest = buffer.str() + offset;
+			int count = buffer.getSize() - offset;
+			bool fixed = ring->bind(buffer.str(), buffer.getSize(), buffer.getVersion());
+
+			while (true)
+			{
+				int res = 0;
+				int cnt = sendcnt;
+				int sent = sendlen;
+				int recved = -ECANCELED;
+				unsigned long long data = 0;
+
+				if (cnt > 0) ring->prepare(IORING_OP_WRITEV, sock, sendvec, cnt, SEND)->flags |= IOSQE_IO_LINK;
+
+				ring->prepare(fixed ? IORING_OP_READ_FIXED : IORING_OP_RECV, sock, dest, count, RECV);
+
+				while (data != RECV)
+				{
+					if ((res = ring->enter(1, deadline)) < 0)
+					{
+						abort();
+
+						return res;
+					}
+
+					while (data != RECV && ring->reap(data, res))
+					{
+						if (data == SEND)
+						{
+							sent = res;
+						}
+						else
+						{
+							recved = res;
+						}
+					}
+				}
+
+				sendcnt = 0;
+
+				if (cnt > 0 && sent < sendlen)
+				{
+					if (sent < 0) return NETERR;
+
+					Advance(sendvec, cnt, sent);
+
+					if ((res = send(sendvec, cnt, deadline)) < 0) return res;
+
+					continue;
+				}
+
+				if (recved > 0) return recved;
+
+				if (recved == 0) return NETCLOSE;
+
+				if (recved == -EAGAIN || recved == -EINTR)
+				{
+					if ((res = wait(POLLIN, deadline)) < 0) return res;
+
+					continue;
+				}
+
+				return NETERR;
+			}
+		}
+#endif
+
+		static void Advance(struct iovec*& vec, int& cnt, int num)
+		{
+			while (num > 0)
+			{
+				if (num < (int)(vec->iov_len))
+				{
+					vec->iov_base = (char*)(vec->iov_base) + num;
+					vec->iov_len -= num;
+
+					break;
+				}
+
+				num -= vec->iov_len;
+				vec++;
+				cnt--;
+			}
+		}
+
 	public:
+		static long long GetTime()
+		{
+			return chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+		}
 		static bool IsSocketTimeout()
 		{
 #ifndef _MSC_VER
-			return errno == 0 || errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+			return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
 #else
-			return WSAGetLastError() == WSAETIMEDOUT;
+			int err = WSAGetLastError();
+
+			return err == WSAEWOULDBLOCK || err == WSAETIMEDOUT || err == WSAEINTR;
 #endif
 		}
 		static void SocketClose(SOCKET sock)
@@ -123,98 +528,109 @@ public:
 			return setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, (char*)(&ms), sizeof(ms)) == 0;
 #endif
 		}
+		static int SocketWait(SOCKET sock, short events, long long deadline)
+		{
+			struct pollfd pfd;
+
+			while (true)
+			{
+				long long ms = deadline - GetTime();
+
+				if (ms <= 0) return TIMEOUT;
+
+				pfd.fd = sock;
+				pfd.events = events;
+				pfd.revents = 0;
+
+				int res = poll(&pfd, 1, ms < INT_MAX ? (int)(ms) : INT_MAX);
+
+				if (res > 0) return OK;
+
+				if (res < 0 && !IsSocketTimeout()) return NETERR;
+			}
+		}
 		SOCKET SocketConnectTimeout(const char* ip, int port, double timeout)
 		{
 			u_long mode = 1;
-			struct timeval tv;
 			struct sockaddr_in addr;
 			SOCKET sock = socket(AF_INET, SOCK_STREAM, 0);
 
 			if (IsSocketClosed(sock)) return INVALID_SOCKET;
-			
+
 			long ms = (long)(timeout * 1000 + 0.5);
 
-			tv.tv_sec = ms / 1000;
-			tv.tv_usec = ms % 1000;
 			addr.sin_family = AF_INET;
 			addr.sin_port = htons(port);
 			addr.sin_addr.s_addr = inet_addr(ip);
 
-			ioctlsocket(sock, FIONBIO, &mode); mode = 0;
-
-			if (::connect(sock, (struct sockaddr*)(&addr), sizeof(addr)) == 0)
-			{
-				ioctlsocket(sock, FIONBIO, &mode);
-
-				return sock;
-			}
+			ioctlsocket(sock, FIONBIO, &mode);
 
-#ifndef _MSC_VER
-			struct epoll_event ev;
-			struct epoll_event evs;
-			int handle = epoll_create(1);
+			if (::connect(sock, (struct sockaddr*)(&addr), sizeof(addr)) == 0) return sock;
 
-			if (handle < 0)
+			if (SocketWait(sock, POLLOUT, GetTime() + ms) == OK)
 			{
-				SocketClose(sock);
-			
-				return INVALID_SOCKET;
-			}
-			
-			memset(&ev, 0, sizeof(ev));
-			
-			ev.events = EPOLLOUT | EPOLLERR | EPOLLHUP;
-			
-			epoll_ctl(handle, EPOLL_CTL_ADD, sock, &ev);
-			
-			if (epoll_wait(handle, &evs, 1, ms) > 0)
-			{
-				if (evs.events & EPOLLOUT)
-				{
-					int res = FAIL;
-					socklen_t len = sizeof(res);
-			
-					getsockopt(sock, SOL_SOCKET, SO_ERROR, (char*)(&res), &len);
-					ioctlsocket(sock, FIONBIO, &mode);
-			
-					if (res == 0)
-					{
-						::close(handle);
-			
-						return sock;
-					}
-				}
-			}
-			
-			::close(handle);
-#else
-			fd_set ws;
-			FD_ZERO(&ws);
-			FD_SET(sock, &ws);
+				int res = FAIL;
+				socklen_t len = sizeof(res);
 
-			if (select(sock + 1, NULL, &ws, NULL, &tv) > 0)
-			{
-				int res = ERROR;
-				int len = sizeof(res);
-			
 				getsockopt(sock, SOL_SOCKET, SO_ERROR, (char*)(&res), &len);
-				ioctlsocket(sock, FIONBIO, &mode);
-			
+
 				if (res == 0) return sock;
 			}
-#endif
 
 			SocketClose(sock);
-			
+
 			return INVALID_SOCKET;
 		}
 
 	public:
 		void close()
 		{
+#ifdef REDIS_CONNECT_URING
+			if (ring && (sendcnt > 0 || ring->getInflight() > 0)) abort();
+#endif
 			SocketClose(sock);
 			sock = INVALID_SOCKET;
 		}
+		bool isClosed() const
+		{
+			return IsSocketClosed(sock);
+		}
+		SOCKET getHandle() const
+		{
+			return sock;
+		}
+		bool isUring() const
+		{
+#ifdef REDIS_CONNECT_URING
+			return ring ? true : false;
+#else
+			return false;
+#endif
+		}
+		bool setUring(bool flag)
+		{
+#ifdef REDIS_CONNECT_URING
+			if (flag == isUring()) return flag;
+
+			if (flag)
+			{
+				ring.reset(new Uring());
+
+				if (ring->init(URING_ENTRIES)) return true;
+			}
+			else
+			{
+				if (sendcnt > 0 || ring->getInflight() > 0) abort();
+			}
+
+			ring.reset();
+#endif
+			return false;
+		}
+		void shutdown()
+		{
+			if (!IsSocketClosed(sock)) ::shutdown(sock, 2);
+		}
 		bool setSendTimeout(int ms)
 		{
 			return SocketSetSendTimeout(sock, ms);
@@ -231,36 +647,44 @@ public:
 
 			return IsSocketClosed(sock) ? false : true;
 		}
+		int wait(short events, long long deadline)
+		{
+			return SocketWait(sock, events, deadline);
+		}
 
 	public:
-		int write(const void* data, int count)
+		int send(struct iovec* vec, int cnt, long long deadline)
 		{
-			const char* str = (const char*)(data);
-
 			int num = 0;
-			int times = 0;
 			int writed = 0;
 
-			while (writed < count)
+			while (cnt > 0)
 			{
-				if ((num = send(sock, str + writed, count - writed, 0)) > 0)
+				if (vec->iov_len == 0)
 				{
-					if (num > 8)
-					{
-						times = 0;
-					}
-					else
-					{
-						if (++times > 100) return TIMEOUT;
-					}
+					vec++;
+					cnt--;
+
+					continue;
+				}
+
+#ifndef _MSC_VER
+				num = writev(sock, vec, cnt < IOV_MAX ? cnt : IOV_MAX);
+#else
+				num = ::send(sock, (const char*)(vec->iov_base), vec->iov_len, 0);
+#endif
 
+				if (num > 0)
+				{
 					writed += num;
+
+					Advance(vec, cnt, num);
 				}
 				else
 				{
 					if (IsSocketTimeout())
 					{
-						if (++times > 100) return TIMEOUT;
+						if ((num = wait(POLLOUT, deadline)) < 0) return num;
 
 						continue;
 					}
@@ -271,51 +695,43 @@ public:
 
 			return writed;
 		}
-		int read(void* data, int count, bool completed)
+		int write(const void* data, int count, long long deadline)
 		{
-			char* str = (char*)(data);
+			struct iovec iov;
 
-			if (completed)
+			iov.iov_base = (void*)(data);
+			iov.iov_len = count;
+
+			return write(&iov, 1, deadline);
+		}
+		int write(struct iovec* vec, int cnt, long long deadline)
+		{
+#ifdef REDIS_CONNECT_URING
+			if (ring && cnt > 0 && cnt <= IOV_MAX)
 			{
-				int num = 0;
-				int times = 0;
-				int readed = 0;
+				sendlen = 0;
+				sendcnt = cnt;
+				sendvec = vec;
 
-				while (readed < count)
-				{
-					if ((num = recv(sock, str + readed, count - readed, 0)) > 0)
-					{
-						if (num > 8)
-						{
-							times = 0;
-						}
-						else
-						{
-							if (++times > 100) return TIMEOUT;
-						}
+				for (int i = 0; i < cnt; i++) sendlen += vec[i].iov_len;
 
-						readed += num;
-					}
-					else if (num == 0)
-					{
-						return NETCLOSE;
-					}
-					else
-					{
-						if (IsSocketTimeout())
-						{
-							if (++times > 100) return TIMEOUT;
-
-							continue;
-						}
-
-						return NETERR;
-					}
-				}
-
-				return readed;
+				return sendlen;
 			}
-			else
+#endif
+			return send(vec, cnt, deadline);
+		}
+		int read(Buffer& buffer, int offset, long long deadline)
+		{
+#ifdef REDIS_CONNECT_URING
+			if (ring) return submit(buffer, offset, deadline);
+#endif
+			return read(buffer.str() + offset, buffer.getSize() - offset, deadline);
+		}
+		int read(void* data, int count, long long deadline)
+		{
+			char* str = (char*)(data);
+
+			while (true)
 			{
 				int val = recv(sock, str, count, 0);
 
@@ -323,540 +739,4720 @@ public:
 
 				if (val == 0) return NETCLOSE;
 
-				if (IsSocketTimeout()) return 0;
+				if (IsSocketTimeout())
+				{
+					if ((val = wait(POLLIN, deadline)) < 0) return val;
+
+					continue;
+				}
 
 				return NETERR;
 			}
 		}
 	};
 
-	class Command
+	class Buffer
 	{
-		friend RedisConnect;
-
-	protected:
-		int status;
-		string msg;
-		vector<string> res;
-		vector<string> vec;
-
 	protected:
-		int parse(const char* msg, int len)
+		int size = 0;
+		int used = 0;
+		int peak = 0;
+		int maxsz = 0;
+		int version = 0;
+		char* data = NULL;
+
+		bool resize(int len, int keep)
 		{
-			if (*msg == '$')
-			{
-				const char* end = parseNode(msg, len);
+			char* tmp = new char[len];
 
-				if (end == NULL) return DATAERR;
+			if (keep > 0) memcpy(tmp, data, keep);
 
-				switch (end - msg)
-				{
-				case 0: return TIMEOUT;
-				case -1: return NOTFOUND;
-				}
-
-				return OK;
-			}
+			delete[] data;
 
-			const char* str = msg + 1;
-			const char* end = strstr(str, "\r\n");
+			data = tmp;
+			size = len;
+			version++;
 
-			if (end == NULL) return TIMEOUT;
+			if (size > peak) peak = size;
 
-			if (*msg == '+' || *msg == '-' || *msg == ':')
-			{
-				this->status = OK;
-				this->msg = string(str, end);
-
-				if (*msg == '+') return OK;
-				if (*msg == '-') return FAIL;
+			return true;
+		}
 
-				this->status = atoi(str);
+	public:
+		Buffer()
+		{
+		}
+		Buffer(const Buffer&) = delete;
+		Buffer& operator = (const Buffer&) = delete;
+		~Buffer()
+		{
+			close();
+		}
 
-				return OK;
-			}
+	public:
+		void close()
+		{
+			delete[] data;
 
-			if (*msg == '*')
-			{
-				int cnt = atoi(str);
-				const char* tail = msg + len;
+			data = NULL;
+			size = used = 0;
+		}
+		bool init(int maxsz)
+		{
+			close();
 
-				vec.clear();
-				str = end + 2;
+			this->peak = 0;
+			this->maxsz = maxsz;
 
-				while (cnt > 0)
-				{
-					end = parseNode(str, tail - str);
+			return resize(maxsz < BUFFER_MINSZ ? maxsz : BUFFER_MINSZ, 0);
+		}
+		char* reserve(int len)
+		{
+			if (len > used) used = len;
 
-					if (end == NULL) return DATAERR;
-					if (end == str) return TIMEOUT;
+			if (len < size) return data;
 
-					str = end;
-					cnt--;
-				}
+			if (size >= maxsz) return NULL;
 
-				return res.size();
-			}
+			resize(size > maxsz / 2 ? maxsz : size * 2, len);
 
-			return DATAERR;
+			return data;
 		}
-		const char* parseNode(const char* msg, int len)
+		void shrink()
 		{
-			const char* str = msg + 1;
-			const char* end = strstr(str, "\r\n");
+			int len = size;
 
-			if (end == NULL) return msg;
+			while (len > BUFFER_MINSZ && used < len / 4) len /= 2;
 
-			int sz = atoi(str);
+			if (len < size) resize(len, 0);
 
-			if (sz < 0) return msg + sz;
-
-			str = end + 2;
-			end = str + sz + 2;
+			used = 0;
+		}
 
-			if (msg + len < end) return msg;
+	public:
+		char* str() const
+		{
+			return data;
+		}
+		int getSize() const
+		{
+			return size;
+		}
+		int getPeakSize() const
+		{
+			return peak;
+		}
+		int getMaxSize() const
+		{
+			return maxsz;
+		}
+		int getVersion() const
+		{
+			return version;
+		}
+	};
 
-			res.push_back(string(str, str + sz));
+	class View
+	{
+	protected:
+		int len = 0;
+		const char* data = NULL;
 
-			return end;
+	public:
+		View()
+		{
+		}
+		View(const char* data, int len)
+		{
+			this->len = len;
+			this->data = data;
 		}
 
 	public:
-		Command()
+		int size() const
 		{
-			this->status = 0;
+			return len;
 		}
-		void add(const char* val)
+		bool isNull() const
 		{
-			vec.push_back(val);
+			return data == NULL;
 		}
-		void add(const string& val)
+		const char* str() const
+		{
+			return data ? data : "";
+		}
+		string toString() const
 		{
-			vec.push_back(val);
+			return string(str(), len);
 		}
-		template<class DATA_TYPE> void add(DATA_TYPE val)
+		bool operator == (const View& obj) const
 		{
-			add(to_string(val));
+			return len == obj.len && memcmp(str(), obj.str(), len) == 0;
 		}
-		template<class DATA_TYPE, class ...ARGS> void add(DATA_TYPE val, ARGS ...args)
+		bool operator != (const View& obj) const
 		{
-			add(val);
-			add(args...);
+			return !(*this == obj);
 		}
+	};
 
-	public:
-		string toString() const
+	class Reply;
+
+	class Command
+	{
+		friend RedisConnect;
+
+	protected:
+		struct Node
+		{
+			char type;
+			int count;
+			int offset;
+			int len;
+			int next;
+		};
+
+		int code;
+		int mark;
+		int bulk;
+		int attrs;
+		int base;
+		int status;
+		int length;
+		int argc;
+		int timeout;
+		char kind;
+		char head[16];
+		string msg;
+		string raw;
+		string body;
+		const Buffer* src;
+		vector<int> stack;
+		vector<int> owner;
+		vector<Node> tree;
+		vector<pair<int, int>> item;
+		vector<pair<int, View>> ref;
+		mutable vector<string> res;
+
+	protected:
+		void reset()
+		{
+			code = 0;
+			mark = 0;
+			bulk = -1;
+			attrs = 0;
+			base = 0;
+			kind = 0;
+			status = 0;
+			length = 0;
+			src = NULL;
+			msg.clear();
+			raw.clear();
+			res.clear();
+			item.clear();
+			tree.clear();
+			owner.clear();
+			stack.clear();
+		}
+		void detach()
+		{
+			if (src) raw.assign(src->str() + base, length);
+
+			src = NULL;
+		}
+		const char* origin() const
+		{
+			if (src) return src->str() + base;
+
+			return raw.empty() ? NULL : raw.c_str();
+		}
+		void setResult(int code)
+		{
+			this->code = code;
+
+			if (code < 0 && msg.empty()) msg = GetErrorString(code);
+		}
+		void append(char type, int count, int offset, int len)
+		{
+			Node node;
+
+			node.len = len;
+			node.type = type;
+			node.count = count;
+			node.offset = offset;
+			node.next = tree.size() + 1;
+
+			tree.push_back(node);
+		}
+		bool open(char type, int val)
 		{
-			ostringstream out;
+			int cnt = val;
+
+			if (val > 0 && (type == '%' || type == '|'))
+			{
+				if (val > INT_MAX / 2) return false;
 
-			out << "*" << vec.size() << "\r\n";
+				cnt = val * 2;
+			}
 
-			for (const string& item : vec)
+			if (type == '|')
 			{
-				out << "$" << item.length() << "\r\n" << item << "\r\n";
+				cnt++;
+				attrs++;
 			}
 
-			return out.str();
+			owner.push_back(tree.size());
+			append(type, cnt, 0, 0);
+			stack.push_back(cnt);
+
+			return true;
 		}
-		string get(int idx) const
+		bool next()
 		{
-			return res.at(idx);
+			while (stack.size() > 0 && stack.back() <= 0)
+			{
+				if (tree[owner.back()].type == '|') attrs--;
+
+				tree[owner.back()].next = tree.size();
+				owner.pop_back();
+				stack.pop_back();
+			}
+
+			return stack.empty();
 		}
-		const vector<string>& getDataList() const
+		bool hidden() const
 		{
-			return res;
+			const int cnt = stack.size();
+
+			for (int i = 0; i < cnt; i++)
+			{
+				if (tree[owner[i]].type == '|' && stack[i] > (i + 1 < cnt ? 0 : 1)) return true;
+			}
+
+			return false;
 		}
-		int getResult(RedisConnect* redis, int timeout)
+		bool root()
 		{
-			auto doWork = [&]() {
-				string msg = toString();
-				Socket& sock = redis->sock;
+			if (stack.empty()) return true;
 
-				if (sock.write(msg.c_str(), msg.length()) < 0) return NETERR;
+			if (attrs < (int)(stack.size()) || stack.back() != 1) return false;
 
-				int len = 0;
-				int delay = 0;
-				int readed = 0;
-				char* dest = redis->buffer;
-				const int maxsz = redis->memsz;
+			for (int i = 0; i + 1 < (int)(stack.size()); i++)
+			{
+				if (stack[i] > 0) return false;
+			}
 
-				timeout *= 1000;
+			stack.back()--;
+			next();
 
-				while (readed < maxsz)
+			return true;
+		}
+		bool skip()
+		{
+			if (tree.empty() || tree[0].type != '>') return false;
+
+			item.clear();
+			tree.clear();
+
+			return true;
+		}
+		int parse(const char* msg, int len)
+		{
+			while (true)
+			{
+				if (bulk >= 0)
 				{
-					if ((len = sock.read(dest + readed, maxsz - readed, false)) < 0) return len;
+					const char* str = msg + length;
 
-					if (len == 0)
+					if (len - length - 2 < bulk) return TIMEOUT;
+
+					if (str[bulk] != '\r' || str[bulk + 1] != '\n') return DATAERR;
+
+					int size = bulk;
+					int pos = kind == '=' && size >= 4 ? 4 : 0;
+
+					if (attrs == 0 || !hidden()) item.push_back(pair<int, int>(length + pos, size - pos));
+
+					append(kind, 0, length + pos, size - pos);
+					length = mark = length + size + 2;
+					bulk = -1;
+
+					if (root())
 					{
-						delay += SOCKET_TIMEOUT;
+						if (kind != '!') return OK;
+
+						this->status = OK;
+						this->msg = string(str, size);
 
-						if (delay > timeout) return TIMEOUT;
+						return FAIL;
 					}
-					else
+
+					stack.back()--;
+
+					if (next() && !skip()) return item.size();
+
+					continue;
+				}
+
+				if (mark >= len) return TIMEOUT;
+
+				int val = 0;
+				const char* end = NULL;
+				const char* str = msg + length;
+				char type = *str++;
+
+				if (type == '$' || type == '*' || type == ':' || type == '=' || type == '!' || type == '%' || type == '~' || type == '>' || type == '|')
+				{
+					long long num = 0;
+					int cnt = ParseInteger(str, msg + len, num);
+
+					if (cnt == 0)
 					{
-						dest[readed += len] = 0;
+						mark = len;
 
-						if ((len = parse(dest, readed)) == TIMEOUT)
-						{
-							delay = 0;
-						}
-						else
-						{
-							return len;
-						}
+						return TIMEOUT;
 					}
+
+					if (cnt < 0 || (type != ':' && (num > INT_MAX || num < INT_MIN))) return DATAERR;
+
+					val = (int)(num);
+					end = str + cnt - 1;
 				}
+				else
+				{
+					if ((end = (const char*)(memchr(msg + mark, '\n', len - mark))) == NULL)
+					{
+						mark = len;
 
-				return PARAMERR;
-			};
+						return TIMEOUT;
+					}
 
-			status = 0;
-			msg.clear();
+					if (end - str < 1 || end[-1] != '\r') return DATAERR;
+
+					val = atoi(str);
+				}
 
-			redis->code = doWork();
+				length = mark = end + 1 - msg;
 
-			if (redis->code < 0 && msg.empty())
-			{
-				switch (redis->code)
+				if (type == '$' || type == '=' || type == '!')
 				{
-				case SYSERR:
-					msg = "system error";
-					break;
-				case NETERR:
-					msg = "network error";
-					break;
-				case DATAERR:
-					msg = "protocol error";
-					break;
-				case TIMEOUT:
-					msg = "response timeout";
-					break;
-				case NOTFOUND:
-					msg = "element not found";
-					break;
-				default:
-					msg = "unknown error";
-					break;
-				}
-			}
+					if (val >= 0)
+					{
+						if (val > INT_MAX - 2) return DATAERR;
 
-			redis->status = status;
-			redis->msg = msg;
+						kind = type;
+						bulk = val;
 
-			return redis->code;
-		}
-	};
+						continue;
+					}
 
-protected:
-	int code = 0;
-	int port = 0;
-	int memsz = 0;
-	int status = 0;
-	int timeout = 0;
-	char* buffer = NULL;
+					append(type, 0, 0, -1);
 
-	string pwd;
-	string msg;
-	string host;
-	Socket sock;
+					if (root()) return NOTFOUND;
 
-public:
-	~RedisConnect()
-	{
-		close();
-	}
+					if (attrs == 0 || !hidden()) item.push_back(pair<int, int>(0, -1));
+				}
+				else if (type == '*' || type == '%' || type == '~' || type == '>' || type == '|')
+				{
+					if (stack.size() > 0) stack.back()--;
 
-public:
-	int getStatus() const
-	{
-		return status;
-	}
-	int getErrorCode() const
-	{
-		return code;
-	}
-	string getErrorString() const
-	{
-		return msg;
-	}
+					if (!open(type, val)) return DATAERR;
 
-public:
-	void close()
-	{
-		if (buffer)
-		{
-			delete[] buffer;
-			buffer = NULL;
-		}
+					if (next() && !skip()) return item.size();
 
-		sock.close();
-	}
-	bool reconnect()
-	{
-		if (host.empty()) return false;
+					continue;
+				}
+				else if (type == '+' || type == '-' || type == ':' || type == ',' || type == '#' || type == '(' || type == '_')
+				{
+					int pos = str - msg;
+					int size = type == '_' ? -1 : end - 1 - str;
 
-		return connect(host, port, timeout, memsz) && auth(pwd) > 0;
-	}
-	int execute(Command& cmd)
-	{
-		return cmd.getResult(this, timeout);
-	}
-	template<class DATA_TYPE, class ...ARGS>
-	int execute(DATA_TYPE val, ARGS ...args)
-	{
-		Command cmd;
+					append(type, 0, pos, size);
 
-		cmd.add(val, args...);
+					if (root())
+					{
+						if (type == '_') return NOTFOUND;
 
-		return cmd.getResult(this, timeout);
-	}
-	template<class DATA_TYPE, class ...ARGS>
-	int execute(vector<string>& vec, DATA_TYPE val, ARGS ...args)
-	{
-		Command cmd;
+						this->status = OK;
+						this->msg = string(str, end - 1);
 
-		cmd.add(val, args...);
+						if (type == '+') return OK;
+						if (type == '-') return FAIL;
 
-		cmd.getResult(this, timeout);
+						this->status = type == '#' ? *str == 't' : val;
 
-		if (code > 0) std::swap(vec, cmd.res);
+						if (type == ',' || type == '(') item.push_back(pair<int, int>(pos, size));
 
-		return code;
+						return OK;
+					}
+
+					if (attrs == 0 || !hidden()) item.push_back(size < 0 ? pair<int, int>(0, -1) : pair<int, int>(pos, size));
+				}
+				else
+				{
+					return DATAERR;
+				}
+
+				stack.back()--;
+
+				if (next() && !skip()) return item.size();
+			}
+		}
+
+		void bind(const string& val)
+		{
+			if ((int)(val.length()) < INPLACE_MINSZ)
+			{
+				add(val);
+			}
+			else
+			{
+				add(View(val.c_str(), val.length()));
+			}
+		}
+		template<class DATA_TYPE> void bind(const DATA_TYPE& val)
+		{
+			add(val);
+		}
+		template<class DATA_TYPE, class ...ARGS> void bind(const DATA_TYPE& val, const ARGS& ...args)
+		{
+			bind(val);
+			bind(args...);
+		}
+		void append(const char* data, int len)
+		{
+			header(len);
+			body.append(data, len);
+			body.append("\r\n", 2);
+			argc++;
+		}
+		void header(int len)
+		{
+			char tmp[32];
+
+			tmp[0] = '$';
+			len = Format(tmp + 1, len, false) + 1;
+			tmp[len++] = '\r';
+			tmp[len++] = '\n';
+
+			body.append(tmp, len);
+		}
+		static int ParseInteger(const char* str, const char* end, long long& val)
+		{
+			const char* ptr = str;
+			unsigned long long res = 0;
+			bool neg = ptr < end && *ptr == '-';
+
+			if (neg) ptr++;
+
+			const char* head = ptr;
+
+			while (ptr < end && *ptr >= '0' && *ptr <= '9')
+			{
+				if (ptr - head >= 19) return -1;
+
+				res = res * 10 + (*ptr++ - '0');
+			}
+
+			if (ptr + 2 > end) return ptr < end && *ptr != '\r' ? -1 : 0;
+
+			if (ptr == head || ptr[0] != '\r' || ptr[1] != '\n') return -1;
+
+			if (res > (unsigned long long)(LLONG_MAX) + neg) return -1;
+
+			val = (long long)(neg ? 0 - res : res);
+
+			return ptr + 2 - str;
+		}
+		static int Format(char* dest, unsigned long long val, bool neg)
+		{
+			char tmp[24];
+			char* str = tmp + sizeof(tmp);
+
+			do
+			{
+				*--str = '0' + val % 10;
+			} while (val /= 10);
+
+			if (neg) *--str = '-';
+
+			int len = tmp + sizeof(tmp) - str;
+
+			memcpy(dest, str, len);
+
+			return len;
+		}
+		int getIovec(vector<struct iovec>& vec)
+		{
+			int off = 0;
+			struct iovec iov;
+			auto push = [&](const char* data, int len) {
+				iov.iov_base = (void*)(data);
+				iov.iov_len = len;
+				vec.push_back(iov);
+			};
+
+			push(head, snprintf(head, sizeof(head), "*%d\r\n", argc));
+
+			for (const pair<int, View>& item : ref)
+			{
+				push(body.c_str() + off, item.first - off);
+				push(item.second.str(), item.second.size());
+				off = item.first;
+			}
+
+			push(body.c_str() + off, body.length() - off);
+
+			return ref.size() * 2 + 2;
+		}
+
+	public:
+		Command()
+		{
+			argc = 0;
+			timeout = 0;
+			memset(head, 0, sizeof(head));
+			reset();
+		}
+		void add(const char* val)
+		{
+			append(val, strlen(val));
+		}
+		void add(const string& val)
+		{
+			append(val.c_str(), val.length());
+		}
+		void add(const View& val)
+		{
+			header(val.size());
+			ref.push_back(pair<int, View>(body.length(), val));
+			body.append("\r\n", 2);
+			argc++;
+		}
+		template<class DATA_TYPE> void add(const DATA_TYPE& val)
+		{
+			char tmp[64];
+
+			if (std::is_floating_point<DATA_TYPE>::value)
+			{
+				append(tmp, snprintf(tmp, sizeof(tmp), "%f", (double)(val)));
+			}
+			else if (val < 0)
+			{
+				append(tmp, Format(tmp, 0 - (unsigned long long)(val), true));
+			}
+			else
+			{
+				append(tmp, Format(tmp, (unsigned long long)(val), false));
+			}
+		}
+		template<class DATA_TYPE, class ...ARGS> void add(const DATA_TYPE& val, const ARGS& ...args)
+		{
+			add(val);
+			add(args...);
+		}
+		void clear()
+		{
+			argc = 0;
+			body.clear();
+			ref.clear();
+			reset();
+		}
+
+	public:
+		string toString() const
+		{
+			int off = 0;
+			string msg = "*" + to_string(argc) + "\r\n";
+
+			for (const pair<int, View>& item : ref)
+			{
+				msg.append(body, off, item.first - off);
+				msg.append(item.second.str(), item.second.size());
+				off = item.first;
+			}
+
+			msg.append(body, off, string::npos);
+
+			return msg;
+		}
+		View getArgument(int idx) const
+		{
+			int off = 0;
+			size_t pos = 0;
+
+			if (idx < 0 || idx >= argc) return View();
+
+			while (true)
+			{
+				int len = atoi(body.c_str() + off + 1);
+
+				off = body.find('\n', off) + 1;
+
+				while (pos < ref.size() && ref[pos].first < off) pos++;
+
+				bool inplace = pos < ref.size() && ref[pos].first == off;
+
+				if (idx-- == 0) return inplace ? ref[pos].second : View(body.c_str() + off, len);
+
+				off += inplace ? 2 : len + 2;
+			}
+		}
+		string get(int idx) const
+		{
+			return getView(idx).toString();
+		}
+		View getView(int idx) const
+		{
+			const pair<int, int>& node = item.at(idx);
+
+			if (node.second < 0) return View();
+
+			if (idx < (int)(res.size())) return View(res[idx].c_str(), res[idx].length());
+
+			const char* data = origin();
+
+			return data ? View(data + node.first, node.second) : View();
+		}
+		Reply getReply() const
+		{
+			return Reply(this, tree.empty() ? -1 : 0);
+		}
+		template<class FUNC> void visit(FUNC func) const
+		{
+			for (int i = 0; i < (int)(item.size()); i++) func(getView(i));
+		}
+		int getDataSize() const
+		{
+			return item.size();
+		}
+		int getTimeout() const
+		{
+			return timeout;
+		}
+		void setTimeout(int ms)
+		{
+			timeout = ms;
+		}
+		int getStatus() const
+		{
+			return status;
+		}
+		int getErrorCode() const
+		{
+			return code;
+		}
+		string getErrorString() const
+		{
+			return msg;
+		}
+		const vector<string>& getDataList() const
+		{
+			while (res.size() < item.size()) res.push_back(getView(res.size()).toString());
+
+			return res;
+		}
+		void takeDataList(vector<string>& vec)
+		{
+			getDataList();
+			std::swap(vec, res);
+			res.clear();
+		}
+		int finish(RedisConnect* redis, int res)
+		{
+			setResult(res);
+
+			if (code == TIMEOUT || code == NETERR || code == NETCLOSE || code == DATAERR || code == PARAMERR) redis->sock.close();
+
+			redis->code = code;
+			redis->status = status;
+			redis->msg = msg;
+
+			return code;
+		}
+		int request(RedisConnect* redis, long long deadline, bool linked)
+		{
+			int len = 0;
+			Socket& sock = redis->sock;
+			vector<struct iovec>& vec = redis->iov;
+
+			reset();
+
+			if (redis->code == SYSBUSY && sock.isClosed()) return finish(redis, SYSBUSY);
+
+			src = &redis->buffer;
+
+			redis->buffer.shrink();
+
+			vec.clear();
+			getIovec(vec);
+
+			if (linked)
+			{
+				len = sock.write(vec.data(), vec.size(), deadline);
+			}
+			else
+			{
+				len = sock.send(vec.data(), vec.size(), deadline);
+			}
+
+			return len < 0 ? finish(redis, len) : len;
+		}
+		int response(RedisConnect* redis, long long deadline)
+		{
+			auto doWork = [&]() {
+				Socket& sock = redis->sock;
+
+				int len = 0;
+				int readed = 0;
+				char* dest = NULL;
+				Buffer& buffer = redis->buffer;
+
+				while ((dest = buffer.reserve(readed)))
+				{
+					if ((len = sock.read(buffer, readed, deadline)) < 0) return len;
+
+					readed += len;
+
+					if ((len = parse(dest, readed)) != TIMEOUT) return len;
+				}
+
+				return PARAMERR;
+			};
+
+			return finish(redis, doWork());
+		}
+		int getResult(RedisConnect* redis, int timeout)
+		{
+			if (this->timeout > 0) timeout = this->timeout;
+
+			long long deadline = Socket::GetTime() + timeout;
+
+			int res = request(redis, deadline, true);
+
+			return res < 0 ? res : response(redis, deadline);
+		}
+	};
+
+	class Reply
+	{
+	protected:
+		int idx;
+		const Command* cmd;
+
+		const Command::Node* node() const
+		{
+			return idx < 0 ? NULL : &cmd->tree[idx];
+		}
+
+	public:
+		Reply(const Command* cmd = NULL, int idx = -1)
+		{
+			this->cmd = cmd;
+			this->idx = idx;
+
+			while (this->idx >= 0 && cmd->tree[this->idx].type == '|')
+			{
+				int cnt = cmd->tree[this->idx].count;
+
+				this->idx++;
+
+				while (--cnt > 0) this->idx = cmd->tree[this->idx].next;
+			}
+		}
+
+	public:
+		char getType() const
+		{
+			return idx < 0 ? 0 : node()->type;
+		}
+		bool isNull() const
+		{
+			const Command::Node* node = this->node();
+
+			return node == NULL || node->count < 0 || node->len < 0;
+		}
+		bool isError() const
+		{
+			return getType() == '-' || getType() == '!';
+		}
+		bool isArray() const
+		{
+			return getType() == '*' || getType() == '~' || getType() == '>';
+		}
+		bool isMap() const
+		{
+			return getType() == '%';
+		}
+		int size() const
+		{
+			const Command::Node* node = this->node();
+
+			return node && node->count > 0 ? node->count : 0;
+		}
+		Reply get(int pos) const
+		{
+			if (pos < 0 || pos >= size()) return Reply();
+
+			int res = idx + 1;
+
+			while (pos-- > 0) res = cmd->tree[res].next;
+
+			return Reply(cmd, res);
+		}
+		Reply operator [] (int pos) const
+		{
+			return get(pos);
+		}
+		Reply find(const View& key) const
+		{
+			int cnt = size();
+			int res = idx + 1;
+
+			for (int i = 0; i + 1 < cnt; i += 2)
+			{
+				if (Reply(cmd, res).getView() == key) return Reply(cmd, cmd->tree[res].next);
+
+				res = cmd->tree[cmd->tree[res].next].next;
+			}
+
+			return Reply();
+		}
+		template<class FUNC> void visit(FUNC func) const
+		{
+			int cnt = size();
+			int res = idx + 1;
+
+			for (int i = 0; i < cnt; i++)
+			{
+				func(Reply(cmd, res));
+				res = cmd->tree[res].next;
+			}
+		}
+
+	public:
+		View getView() const
+		{
+			const Command::Node* node = this->node();
+
+			if (node == NULL || node->len < 0 || isArray() || isMap()) return View();
+
+			const char* data = cmd->origin();
+
+			return data ? View(data + node->offset, node->len) : View();
+		}
+		string toString() const
+		{
+			return getView().toString();
+		}
+		long long toInteger() const
+		{
+			if (getType() == '#') return *getView().str() == 't';
+
+			return strtoll(getView().str(), NULL, 10);
+		}
+		double toDouble() const
+		{
+			return strtod(getView().str(), NULL);
+		}
+	};
+
+	class Pipeline
+	{
+		friend RedisConnect;
+
+	protected:
+		vector<Command> vec;
+
+	public:
+		template<class DATA_TYPE, class ...ARGS> void add(const DATA_TYPE& val, const ARGS& ...args)
+		{
+			vec.push_back(Command());
+			vec.back().add(val, args...);
+		}
+		void add(const Command& cmd)
+		{
+			vec.push_back(cmd);
+		}
+		void clear()
+		{
+			vec.clear();
+		}
+		int size() const
+		{
+			return vec.size();
+		}
+
+	public:
+		string toString() const
+		{
+			string msg;
+
+			for (const Command& cmd : vec) msg += cmd.toString();
+
+			return msg;
+		}
+		Command& get(int idx)
+		{
+			return vec.at(idx);
+		}
+		const vector<Command>& getCommandList() const
+		{
+			return vec;
+		}
+		int finish(RedisConnect* redis, int idx, int res)
+		{
+			if (res < 0)
+			{
+				if (res == TIMEOUT || res == NETERR || res == NETCLOSE || res == DATAERR || res == PARAMERR) redis->sock.close();
+
+				while (idx < (int)(vec.size())) vec[idx++].setResult(res);
+			}
+
+			redis->code = res;
+			redis->status = 0;
+			redis->msg = res < 0 ? GetErrorString(res) : "";
+
+			return res;
+		}
+		int request(RedisConnect* redis, long long deadline, bool linked)
+		{
+			int len = 0;
+			Socket& sock = redis->sock;
+			vector<struct iovec>& iov = redis->iov;
+
+			iov.clear();
+
+			for (Command& cmd : vec)
+			{
+				cmd.reset();
+				cmd.getIovec(iov);
+			}
+
+			if (redis->code == SYSBUSY && sock.isClosed()) return finish(redis, 0, SYSBUSY);
+
+			redis->buffer.shrink();
+
+			if (linked)
+			{
+				len = sock.write(iov.data(), iov.size(), deadline);
+			}
+			else
+			{
+				len = sock.send(iov.data(), iov.size(), deadline);
+			}
+
+			return len < 0 ? finish(redis, 0, len) : len;
+		}
+		int response(RedisConnect* redis, long long deadline, int timeout)
+		{
+			int idx = 0;
+			const int cnt = vec.size();
+
+			auto doWork = [&]() {
+				Socket& sock = redis->sock;
+
+				int len = 0;
+				int done = 0;
+				int offset = 0;
+				int readed = 0;
+				char* dest = NULL;
+				Buffer& buffer = redis->buffer;
+
+				while (idx < cnt)
+				{
+					if (offset > 0 && readed >= buffer.getSize())
+					{
+						while (done < idx) vec[done++].detach();
+
+						memmove(buffer.str(), buffer.str() + offset, readed - offset);
+						readed -= offset;
+						offset = 0;
+					}
+
+					if ((dest = buffer.reserve(readed)) == NULL) return PARAMERR;
+
+					if ((len = sock.read(buffer, readed, deadline)) < 0) return len;
+
+					readed += len;
+
+					while (idx < cnt)
+					{
+						Command& cmd = vec[idx];
+
+						cmd.src = &buffer;
+						cmd.base = offset;
+
+						if ((len = cmd.parse(dest + offset, readed - offset)) == TIMEOUT) break;
+
+						if (len == DATAERR) return DATAERR;
+
+						cmd.setResult(len);
+						offset += cmd.length;
+						idx++;
+
+						deadline = Socket::GetTime() + timeout;
+					}
+				}
+
+				return cnt;
+			};
+
+			int res = doWork();
+
+			return finish(redis, idx, res);
+		}
+		int getResult(RedisConnect* redis, int timeout)
+		{
+			long long deadline = Socket::GetTime() + timeout;
+
+			int res = request(redis, deadline, true);
+
+			return res < 0 ? res : response(redis, deadline, timeout);
+		}
+	};
+
+	class Multiplexer
+	{
+	public:
+		typedef function<void(Command&)> Callback;
+
+	protected:
+		struct Task
+		{
+			Callback callback;
+			long long deadline;
+			shared_ptr<Command> cmd;
+		};
+
+		bool broken = false;
+		bool stopped = true;
+		shared_ptr<RedisConnect> redis;
+		vector<Task> pending;
+		deque<Task> inflight;
+
+		Mutex mtx;
+		thread reader;
+		thread writer;
+		condition_variable readable;
+		condition_variable writable;
+
+		void fail(deque<Task>& vec, int code)
+		{
+			for (Task& task : vec)
+			{
+				task.cmd->reset();
+				task.cmd->setResult(code);
+				task.callback(*task.cmd);
+			}
+
+			vec.clear();
+		}
+		void writeLoop()
+		{
+			vector<Task> vec;
+			vector<struct iovec> iov;
+
+			while (true)
+			{
+				unique_lock<Mutex> lk(mtx);
+
+				writable.wait(lk, [this](){ return stopped || pending.size() > 0; });
+
+				if (stopped) return;
+
+				vec.swap(pending);
+
+				if (broken)
+				{
+					lk.unlock();
+
+					bool res = redis->reconnect();
+
+					lk.lock();
+
+					if (res)
+					{
+						broken = false;
+					}
+					else
+					{
+						deque<Task> tmp(vec.begin(), vec.end());
+
+						vec.clear();
+						lk.unlock();
+						fail(tmp, NETERR);
+
+						continue;
+					}
+				}
+
+				long long now = Socket::GetTime();
+
+				iov.clear();
+
+				for (Task& task : vec)
+				{
+					Command& cmd = *task.cmd;
+
+					cmd.reset();
+					cmd.getIovec(iov);
+					task.deadline = now + (cmd.timeout > 0 ? cmd.timeout : redis->timeout);
+					inflight.push_back(std::move(task));
+				}
+
+				vec.clear();
+				readable.notify_one();
+				lk.unlock();
+
+				if (redis->sock.write(iov.data(), iov.size(), now + redis->timeout) < 0) redis->sock.shutdown();
+			}
+		}
+		void readLoop()
+		{
+			int len = 0;
+			int offset = 0;
+			int readed = 0;
+			char* dest = NULL;
+			Buffer& buffer = redis->buffer;
+
+			while (true)
+			{
+				unique_lock<Mutex> lk(mtx);
+
+				readable.wait(lk, [this](){ return stopped || inflight.size() > 0; });
+
+				if (inflight.empty()) return;
+
+				Task& task = inflight.front();
+				Command& cmd = *task.cmd;
+
+				lk.unlock();
+
+				cmd.src = &buffer;
+				cmd.base = offset;
+
+				if ((len = cmd.parse(buffer.str() + offset, readed - offset)) == TIMEOUT)
+				{
+					if (offset > 0 && readed >= buffer.getSize())
+					{
+						memmove(buffer.str(), buffer.str() + offset, readed - offset);
+						readed -= offset;
+						offset = 0;
+					}
+
+					if ((dest = buffer.reserve(readed)) == NULL)
+					{
+						len = PARAMERR;
+					}
+					else if ((len = redis->sock.read(buffer, readed, task.deadline)) > 0)
+					{
+						readed += len;
+
+						continue;
+					}
+				}
+				else if (len != DATAERR)
+				{
+					Task tmp;
+
+					cmd.setResult(len);
+					offset += cmd.length;
+
+					if (offset == readed) offset = readed = 0;
+
+					lk.lock();
+					tmp = std::move(inflight.front());
+					inflight.pop_front();
+					lk.unlock();
+
+					tmp.callback(cmd);
+					cmd.src = NULL;
+
+					continue;
+				}
+
+				deque<Task> vec;
+
+				redis->sock.shutdown();
+
+				lk.lock();
+				broken = true;
+				vec.swap(inflight);
+				lk.unlock();
+
+				fail(vec, len);
+
+				offset = readed = 0;
+			}
+		}
+
+	public:
+		Multiplexer()
+		{
+			redis = make_shared<RedisConnect>();
+		}
+		~Multiplexer()
+		{
+			close();
+		}
+
+	public:
+		void close()
+		{
+			deque<Task> vec;
+
+			{
+				Locker lk(mtx);
+
+				stopped = true;
+				readable.notify_all();
+				writable.notify_all();
+			}
+
+			redis->sock.shutdown();
+
+			if (reader.joinable()) reader.join();
+			if (writer.joinable()) writer.join();
+
+			vec.insert(vec.end(), pending.begin(), pending.end());
+			vec.insert(vec.end(), inflight.begin(), inflight.end());
+			pending.clear();
+			inflight.clear();
+
+			fail(vec, NETCLOSE);
+
+			redis->close();
+		}
+		bool connect(const string& host, int port, const string& pwd = "", double timeout = 3, int memsz = BUFFER_MAXSZ)
+		{
+			close();
+
+			if (redis->connect(host, port, timeout, memsz) && redis->auth(pwd) > 0)
+			{
+				broken = false;
+				stopped = false;
+				reader = thread([this](){ readLoop(); });
+				writer = thread([this](){ writeLoop(); });
+
+				return true;
+			}
+
+			redis->close();
+
+			return false;
+		}
+		void submit(const shared_ptr<Command>& cmd, Callback callback)
+		{
+			Task task;
+
+			task.cmd = cmd;
+			task.deadline = 0;
+			task.callback = std::move(callback);
+
+			{
+				Locker lk(mtx);
+
+				if (!stopped)
+				{
+					pending.push_back(std::move(task));
+					writable.notify_one();
+
+					return;
+				}
+			}
+
+			deque<Task> vec(1, std::move(task));
+
+			fail(vec, NETCLOSE);
+		}
+		future<shared_ptr<Command>> submit(const shared_ptr<Command>& cmd)
+		{
+			shared_ptr<promise<shared_ptr<Command>>> res = make_shared<promise<shared_ptr<Command>>>();
+
+			submit(cmd, [res, cmd](Command& data){
+				data.detach();
+				res->set_value(cmd);
+			});
+
+			return res->get_future();
+		}
+		template<class DATA_TYPE, class ...ARGS>
+		future<shared_ptr<Command>> execute(const DATA_TYPE& val, const ARGS& ...args)
+		{
+			shared_ptr<Command> cmd = make_shared<Command>();
+
+			cmd->add(val, args...);
+
+			return submit(cmd);
+		}
+	};
+
+	class Subscriber
+	{
+	public:
+		typedef function<void(const View&, const View&)> Callback;
+
+	protected:
+		typedef map<string, Callback> Table;
+
+		struct Message
+		{
+			View channel;
+			View message;
+			View pattern;
+		};
+
+		struct Batch
+		{
+			Buffer buffer;
+			vector<Message> list;
+		};
+
+		bool stopped = true;
+		atomic<bool> connected{false};
+		atomic<long long> id{0};
+		shared_ptr<RedisConnect> redis;
+		shared_ptr<const Table> channels;
+		shared_ptr<const Table> patterns;
+		deque<unique_ptr<Batch>> queue;
+		vector<unique_ptr<Batch>> freelist;
+		atomic<long long> received{0};
+		atomic<long long> reconnected{0};
+
+		Mutex mtx;
+		thread reader;
+		thread worker;
+		condition_variable readable;
+		condition_variable writable;
+
+		int send(const char* name, const Table& table)
+		{
+			Command cmd;
+			vector<struct iovec> vec;
+
+			if (table.empty()) return OK;
+
+			cmd.add(name);
+
+			for (const auto& item : table) cmd.add(item.first);
+
+			cmd.getIovec(vec);
+
+			return redis->sock.send(vec.data(), vec.size(), Socket::GetTime() + redis->timeout);
+		}
+		int send(const char* name, const string& key)
+		{
+			Command cmd;
+			vector<struct iovec> vec;
+
+			cmd.add(name, key);
+			cmd.getIovec(vec);
+
+			if (redis->sock.send(vec.data(), vec.size(), Socket::GetTime() + redis->timeout) >= 0) return OK;
+
+			redis->sock.shutdown();
+
+			return OK;
+		}
+		bool restore(const Table& channels, const Table& patterns)
+		{
+			id = redis->execute("client", "id") > 0 ? redis->getStatus() : 0;
+
+			return send("subscribe", channels) >= 0 && send("psubscribe", patterns) >= 0;
+		}
+		void sync(const char* add, const char* del, const Table& prev, const Table& next)
+		{
+			for (const auto& item : next)
+			{
+				if (prev.find(item.first) == prev.end()) send(add, item.first);
+			}
+
+			for (const auto& item : prev)
+			{
+				if (next.find(item.first) == next.end()) send(del, item.first);
+			}
+		}
+		unique_ptr<Batch> fetch()
+		{
+			unique_ptr<Batch> batch;
+
+			{
+				Locker lk(mtx);
+
+				if (freelist.size() > 0)
+				{
+					batch = std::move(freelist.back());
+					freelist.pop_back();
+
+					return batch;
+				}
+			}
+
+			batch.reset(new Batch());
+			batch->buffer.init(redis->memsz);
+
+			return batch;
+		}
+		bool recover()
+		{
+			int delay = SUBSCRIBE_BACKOFF;
+
+			while (true)
+			{
+				shared_ptr<const Table> channels;
+				shared_ptr<const Table> patterns;
+
+				{
+					Locker lk(mtx);
+
+					if (stopped) return false;
+
+					connected = false;
+					channels = this->channels;
+					patterns = this->patterns;
+				}
+
+				if (redis->reconnect() && restore(*channels, *patterns))
+				{
+					Locker lk(mtx);
+
+					if (stopped) return false;
+
+					if (channels != this->channels) sync("subscribe", "unsubscribe", *channels, *this->channels);
+					if (patterns != this->patterns) sync("psubscribe", "punsubscribe", *patterns, *this->patterns);
+
+					reconnected++;
+					connected = true;
+
+					return true;
+				}
+
+				redis->sock.close();
+
+				unique_lock<Mutex> lk(mtx);
+
+				if (!stopped) writable.wait_for(lk, chrono::milliseconds(delay));
+
+				if ((delay *= 2) > SUBSCRIBE_BACKOFF * 64) delay = SUBSCRIBE_BACKOFF * 64;
+			}
+		}
+		static void Collect(Command& cmd, Batch& batch)
+		{
+			int idx = 0;
+			Message msg;
+			int cnt = cmd.getDataSize();
+			View kind = cmd.getView(0);
+
+			if (cnt >= 2 && kind == View("message", 7))
+			{
+				idx = 2;
+			}
+			else if (cnt >= 3 && kind == View("pmessage", 8))
+			{
+				idx = 3;
+				msg.pattern = cmd.getView(1);
+			}
+			else
+			{
+				return;
+			}
+
+			msg.channel = cmd.getView(idx - 1);
+
+			if (idx == cnt) batch.list.push_back(msg);
+
+			while (idx < cnt)
+			{
+				msg.message = cmd.getView(idx++);
+				batch.list.push_back(msg);
+			}
+		}
+		void readLoop()
+		{
+			int len = 0;
+			int offset = 0;
+			int readed = 0;
+			bool pinged = false;
+			Command cmd;
+			unique_ptr<Batch> batch = fetch();
+
+			while (true)
+			{
+				Buffer& buffer = batch->buffer;
+
+				while (offset < readed)
+				{
+					cmd.src = &buffer;
+					cmd.base = offset;
+
+					if ((len = cmd.parse(buffer.str() + offset, readed - offset)) == TIMEOUT || len == DATAERR) break;
+
+					offset += cmd.length;
+
+					if (len > 0) Collect(cmd, *batch);
+
+					cmd.reset();
+				}
+
+				if (batch->list.size() > 0)
+				{
+					unique_ptr<Batch> next = fetch();
+
+					readed -= offset;
+
+					while (readed >= next->buffer.getSize() && next->buffer.reserve(next->buffer.getSize())) continue;
+
+					if (readed > 0) memcpy(next->buffer.str(), buffer.str() + offset, readed);
+
+					received += batch->list.size();
+
+					{
+						unique_lock<Mutex> lk(mtx);
+
+						writable.wait(lk, [this](){ return stopped || queue.size() < SUBSCRIBE_BACKLOG; });
+
+						queue.push_back(std::move(batch));
+						readable.notify_one();
+					}
+
+					batch = std::move(next);
+					offset = 0;
+
+					continue;
+				}
+
+				if (offset == readed)
+				{
+					offset = readed = 0;
+				}
+				else if (offset > 0 && readed >= buffer.getSize())
+				{
+					memmove(buffer.str(), buffer.str() + offset, readed - offset);
+					readed -= offset;
+					offset = 0;
+				}
+
+				if (len == DATAERR)
+				{
+					len = NETERR;
+				}
+				else if (buffer.reserve(readed) == NULL)
+				{
+					len = PARAMERR;
+				}
+				else if ((len = redis->sock.read(buffer, readed, Socket::GetTime() + SUBSCRIBE_IDLE)) > 0)
+				{
+					readed += len;
+					pinged = false;
+
+					continue;
+				}
+
+				if (len == TIMEOUT && !pinged)
+				{
+					Locker lk(mtx);
+
+					pinged = send("ping", "") >= 0;
+
+					continue;
+				}
+
+				cmd.reset();
+				pinged = false;
+				connected = false;
+				offset = readed = 0;
+
+				if (!recover()) return;
+			}
+		}
+		void workLoop()
+		{
+			string key;
+
+			while (true)
+			{
+				unique_ptr<Batch> batch;
+				shared_ptr<const Table> channels;
+				shared_ptr<const Table> patterns;
+
+				{
+					unique_lock<Mutex> lk(mtx);
+
+					readable.wait(lk, [this](){ return stopped || queue.size() > 0; });
+
+					if (queue.empty()) return;
+
+					batch = std::move(queue.front());
+					queue.pop_front();
+					writable.notify_one();
+
+					channels = this->channels;
+					patterns = this->patterns;
+				}
+
+				for (const Message& msg : batch->list)
+				{
+					const Table& table = msg.pattern.isNull() ? *channels : *patterns;
+					const View& name = msg.pattern.isNull() ? msg.channel : msg.pattern;
+
+					key.assign(name.str(), name.size());
+
+					auto it = table.find(key);
+
+					if (it != table.end()) it->second(msg.channel, msg.message);
+				}
+
+				batch->list.clear();
+				batch->buffer.shrink();
+
+				Locker lk(mtx);
+
+				freelist.push_back(std::move(batch));
+			}
+		}
+		int update(shared_ptr<const Table>& table, const char* name, const string& key, Callback func)
+		{
+			Locker lk(mtx);
+			shared_ptr<Table> tmp = make_shared<Table>(*table);
+
+			if (func)
+			{
+				(*tmp)[key] = std::move(func);
+			}
+			else
+			{
+				tmp->erase(key);
+			}
+
+			table = tmp;
+
+			return stopped || !connected ? OK : send(name, key);
+		}
+
+	public:
+		Subscriber()
+		{
+			redis = make_shared<RedisConnect>();
+			channels = make_shared<Table>();
+			patterns = make_shared<Table>();
+		}
+		~Subscriber()
+		{
+			close();
+		}
+
+	public:
+		void close()
+		{
+			{
+				Locker lk(mtx);
+
+				stopped = true;
+				connected = false;
+				readable.notify_all();
+				writable.notify_all();
+
+				redis->sock.shutdown();
+			}
+
+			if (reader.joinable()) reader.join();
+			if (worker.joinable()) worker.join();
+
+			queue.clear();
+			freelist.clear();
+			redis->close();
+		}
+		bool connect(const string& host, int port, const string& pwd = "", double timeout = 3, int memsz = BUFFER_MAXSZ)
+		{
+			close();
+
+			if (redis->connect(host, port, timeout, memsz) && redis->auth(pwd) > 0 && restore(*channels, *patterns))
+			{
+				stopped = false;
+				connected = true;
+				reader = thread([this](){ readLoop(); });
+				worker = thread([this](){ workLoop(); });
+
+				return true;
+			}
+
+			redis->close();
+
+			return false;
+		}
+		int subscribe(const string& channel, Callback func)
+		{
+			return func ? update(channels, "subscribe", channel, std::move(func)) : PARAMERR;
+		}
+		int psubscribe(const string& pattern, Callback func)
+		{
+			return func ? update(patterns, "psubscribe", pattern, std::move(func)) : PARAMERR;
+		}
+		int unsubscribe(const string& channel)
+		{
+			return update(channels, "unsubscribe", channel, Callback());
+		}
+		int punsubscribe(const string& pattern)
+		{
+			return update(patterns, "punsubscribe", pattern, Callback());
+		}
+		bool isConnected() const
+		{
+			return connected.load();
+		}
+		long long getClientId() const
+		{
+			return id.load();
+		}
+		long long getMessageCount() const
+		{
+			return received.load();
+		}
+		long long getReconnectCount() const
+		{
+			return reconnected.load();
+		}
+	};
+
+	class NearCache
+	{
+	protected:
+		struct Entry
+		{
+			int code = 0;
+			long long size = 0;
+			string key;
+			string val;
+			map<string, pair<int, string>> fields;
+		};
+
+		struct Shard
+		{
+			Mutex mtx;
+			long long epoch = 0;
+			long long memsz = 0;
+			list<Entry> lru;
+			unordered_map<string, list<Entry>::iterator> index;
+		};
+
+		long long maxmem = 0;
+		bool started = false;
+		vector<string> prefixes;
+
+		Mutex mtx;
+		Subscriber sub;
+		shared_ptr<RedisConnect> tracker;
+		atomic<bool> tracking{false};
+		atomic<long long> utime{0};
+		atomic<long long> version{0};
+		atomic<long long> hits{0};
+		atomic<long long> misses{0};
+		atomic<long long> invalidated{0};
+		Shard shards[NEARCACHE_SHARDS];
+
+		Shard& getShard(const string& key)
+		{
+			return shards[hash<string>()(key) % NEARCACHE_SHARDS];
+		}
+		bool isTracked(const string& key) const
+		{
+			if (prefixes.empty()) return true;
+
+			for (const string& prefix : prefixes)
+			{
+				if (key.compare(0, prefix.length(), prefix) == 0) return true;
+			}
+
+			return false;
+		}
+		bool enable()
+		{
+			Command cmd;
+			long long cnt = sub.getReconnectCount();
+
+			clear();
+
+			if (!started && !(started = sub.connect(tracker->host, tracker->port, tracker->pwd, tracker->timeout / 1000.0, tracker->memsz))) return false;
+
+			if (!sub.isConnected() || !tracker->reconnect()) return false;
+
+			cmd.add("client", "tracking", "on", "redirect", sub.getClientId(), "bcast");
+
+			for (const string& prefix : prefixes) cmd.add("prefix", prefix);
+
+			if (tracker->execute(cmd) < 0) return false;
+
+			version = cnt;
+
+			return true;
+		}
+		bool check()
+		{
+			long long now = Socket::GetTime();
+			long long last = utime.load();
+
+			if (!(sub.isConnected() && version.load() == sub.getReconnectCount()) && tracking.exchange(false)) clear();
+
+			if (last + NEARCACHE_REFRESH > now || !utime.compare_exchange_strong(last, now)) return tracking.load();
+
+			Locker lk(mtx);
+
+			if (tracking.load() && tracker->ping() > 0) return true;
+
+			tracking = false;
+
+			return tracking = enable();
+		}
+		void erase(Shard& shard, const string& key)
+		{
+			auto it = shard.index.find(key);
+
+			shard.epoch++;
+
+			if (it == shard.index.end()) return;
+
+			shard.memsz -= it->second->size;
+			shard.lru.erase(it->second);
+			shard.index.erase(it);
+		}
+		void invalidate(const View& key)
+		{
+			invalidated++;
+
+			if (key.isNull())
+			{
+				clear();
+
+				return;
+			}
+
+			string tmp = key.toString();
+			Shard& shard = getShard(tmp);
+			Locker lk(shard.mtx);
+
+			erase(shard, tmp);
+		}
+		void drop(const string& key)
+		{
+			Shard& shard = getShard(key);
+			Locker lk(shard.mtx);
+
+			erase(shard, key);
+		}
+		template<class FUNC> bool find(const string& key, long long& epoch, FUNC func)
+		{
+			Shard& shard = getShard(key);
+			Locker lk(shard.mtx);
+			auto it = shard.index.find(key);
+
+			if (it != shard.index.end() && func(*it->second))
+			{
+				shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+				hits++;
+
+				return true;
+			}
+
+			epoch = shard.epoch;
+			misses++;
+
+			return false;
+		}
+		template<class FUNC> void fill(const string& key, long long epoch, FUNC func)
+		{
+			Shard& shard = getShard(key);
+			Locker lk(shard.mtx);
+
+			if (shard.epoch != epoch) return;
+
+			auto it = shard.index.find(key);
+
+			if (it == shard.index.end())
+			{
+				shard.lru.push_front(Entry());
+				shard.lru.front().key = key;
+				it = shard.index.insert(make_pair(key, shard.lru.begin())).first;
+			}
+			else
+			{
+				shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+			}
+
+			Entry& entry = *it->second;
+
+			func(entry);
+
+			shard.memsz -= entry.size;
+			entry.size = key.length() * 2 + entry.val.length() + NEARCACHE_OVERHEAD;
+
+			for (const auto& item : entry.fields) entry.size += item.first.length() + item.second.second.length() + NEARCACHE_OVERHEAD;
+
+			shard.memsz += entry.size;
+
+			while (shard.memsz > maxmem / NEARCACHE_SHARDS && shard.lru.size() > 1)
+			{
+				Entry& item = shard.lru.back();
+
+				shard.memsz -= item.size;
+				shard.index.erase(item.key);
+				shard.lru.pop_back();
+			}
+		}
+
+	public:
+		NearCache()
+		{
+			tracker = make_shared<RedisConnect>();
+		}
+		~NearCache()
+		{
+			sub.close();
+		}
+
+	public:
+		bool init(const RedisConnect* temp, long long maxmem, const vector<string>& prefixes = vector<string>())
+		{
+			Locker lk(mtx);
+
+			this->maxmem = maxmem;
+			this->prefixes = prefixes;
+
+			sub.subscribe("__redis__:invalidate", [this](const View&, const View& key){
+				invalidate(key);
+			});
+
+			tracker->host = temp->host;
+			tracker->port = temp->port;
+			tracker->pwd = temp->pwd;
+			tracker->memsz = temp->memsz;
+			tracker->timeout = temp->timeout;
+			utime = Socket::GetTime();
+			started = false;
+
+			return tracking = enable();
+		}
+		void clear()
+		{
+			for (Shard& shard : shards)
+			{
+				Locker lk(shard.mtx);
+
+				shard.epoch++;
+				shard.memsz = 0;
+				shard.lru.clear();
+				shard.index.clear();
+			}
+		}
+		bool isTracking() const
+		{
+			return tracking.load();
+		}
+		long long getHitCount() const
+		{
+			return hits.load();
+		}
+		long long getMissCount() const
+		{
+			return misses.load();
+		}
+		long long getInvalidateCount() const
+		{
+			return invalidated.load();
+		}
+		long long getMemorySize()
+		{
+			long long res = 0;
+
+			for (Shard& shard : shards)
+			{
+				Locker lk(shard.mtx);
+
+				res += shard.memsz;
+			}
+
+			return res;
+		}
+		size_t size()
+		{
+			size_t res = 0;
+
+			for (Shard& shard : shards)
+			{
+				Locker lk(shard.mtx);
+
+				res += shard.lru.size();
+			}
+
+			return res;
+		}
+
+	public:
+		int get(const string& key, string& val)
+		{
+			int code = 0;
+			long long epoch = 0;
+
+			if (!isTracked(key) || !check()) return Instance()->get(key, val);
+
+			auto load = [&](const Entry& entry){
+				if ((code = entry.code) == OK) val = entry.val;
+
+				return code != 0;
+			};
+
+			if (find(key, epoch, load)) return code;
+
+			if ((code = Instance()->get(key, val)) == OK || code == NOTFOUND)
+			{
+				fill(key, epoch, [&](Entry& entry){
+					entry.code = code;
+					entry.val = code == OK ? val : "";
+				});
+			}
+
+			return code;
+		}
+		int hget(const string& key, const string& filed, string& val)
+		{
+			int code = 0;
+			long long epoch = 0;
+
+			if (!isTracked(key) || !check()) return Instance()->hget(key, filed, val);
+
+			auto load = [&](const Entry& entry){
+				auto it = entry.fields.find(filed);
+
+				if (it == entry.fields.end()) return false;
+
+				if ((code = it->second.first) == OK) val = it->second.second;
+
+				return true;
+			};
+
+			if (find(key, epoch, load)) return code;
+
+			if ((code = Instance()->hget(key, filed, val)) == OK || code == NOTFOUND)
+			{
+				fill(key, epoch, [&](Entry& entry){
+					entry.fields[filed] = make_pair(code, code == OK ? val : "");
+				});
+			}
+
+			return code;
+		}
+		int del(const string& key)
+		{
+			int code = Instance()->del(key);
+
+			drop(key);
+
+			return code;
+		}
+		int set(const string& key, const string& val, int timeout = 0)
+		{
+			int code = Instance()->set(key, val, timeout);
+
+			drop(key);
+
+			return code;
+		}
+		int hdel(const string& key, const string& filed)
+		{
+			int code = Instance()->hdel(key, filed);
+
+			drop(key);
+
+			return code;
+		}
+		int hset(const string& key, const string& filed, const string& val)
+		{
+			int code = Instance()->hset(key, filed, val);
+
+			drop(key);
+
+			return code;
+		}
+	};
+
+#ifdef REDIS_CONNECT_COROUTINE
+	template<class DATA_TYPE> class Task
+	{
+	public:
+		struct promise_type
+		{
+			DATA_TYPE value = DATA_TYPE();
+			coroutine_handle<> next;
+
+			Task get_return_object()
+			{
+				return Task(coroutine_handle<promise_type>::from_promise(*this));
+			}
+			suspend_always initial_suspend() noexcept
+			{
+				return {};
+			}
+			auto final_suspend() noexcept
+			{
+				struct Awaiter
+				{
+					bool await_ready() noexcept
+					{
+						return false;
+					}
+					coroutine_handle<> await_suspend(coroutine_handle<promise_type> handle) noexcept
+					{
+						coroutine_handle<> next = handle.promise().next;
+
+						return next ? next : noop_coroutine();
+					}
+					void await_resume() noexcept
+					{
+					}
+				};
+
+				return Awaiter();
+			}
+			void return_value(DATA_TYPE val)
+			{
+				value = std::move(val);
+			}
+			void unhandled_exception()
+			{
+				std::terminate();
+			}
+		};
+
+	protected:
+		coroutine_handle<promise_type> handle;
+
+	public:
+		explicit Task(coroutine_handle<promise_type> handle)
+		{
+			this->handle = handle;
+		}
+		Task(Task&& obj)
+		{
+			handle = obj.handle;
+			obj.handle = nullptr;
+		}
+		Task(const Task&) = delete;
+		Task& operator = (const Task&) = delete;
+		~Task()
+		{
+			if (handle) handle.destroy();
+		}
+
+	public:
+		bool await_ready() const noexcept
+		{
+			return false;
+		}
+		coroutine_handle<> await_suspend(coroutine_handle<> next) noexcept
+		{
+			handle.promise().next = next;
+
+			return handle;
+		}
+		DATA_TYPE await_resume()
+		{
+			return std::move(handle.promise().value);
+		}
+	};
+
+	class Reactor
+	{
+	public:
+		class Handler
+		{
+		public:
+			virtual ~Handler()
+			{
+			}
+			virtual void process(uint32_t events) = 0;
+		};
+
+		typedef multimap<long long, function<void()>>::iterator Timer;
+
+	protected:
+		struct Detached
+		{
+			struct promise_type
+			{
+				Detached get_return_object()
+				{
+					return Detached();
+				}
+				suspend_never initial_suspend() noexcept
+				{
+					return {};
+				}
+				suspend_never final_suspend() noexcept
+				{
+					return {};
+				}
+				void return_void()
+				{
+				}
+				void unhandled_exception()
+				{
+					std::terminate();
+				}
+			};
+		};
+
+		int handle = -1;
+		int notifier = -1;
+		atomic<bool> stopped{false};
+		deque<coroutine_handle<>> ready;
+		multimap<long long, function<void()>> timers;
+
+		static Detached Launch(Task<int> task)
+		{
+			co_await task;
+		}
+
+	public:
+		Reactor()
+		{
+			struct epoll_event ev;
+
+			handle = epoll_create1(EPOLL_CLOEXEC);
+			notifier = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+			memset(&ev, 0, sizeof(ev));
+
+			ev.events = EPOLLIN;
+			ev.data.ptr = NULL;
+
+			epoll_ctl(handle, EPOLL_CTL_ADD, notifier, &ev);
+		}
+		Reactor(const Reactor&) = delete;
+		Reactor& operator = (const Reactor&) = delete;
+		~Reactor()
+		{
+			::close(notifier);
+			::close(handle);
+		}
+
+	public:
+		bool add(SOCKET sock, Handler* handler, uint32_t events)
+		{
+			return control(EPOLL_CTL_ADD, sock, handler, events);
+		}
+		bool modify(SOCKET sock, Handler* handler, uint32_t events)
+		{
+			return control(EPOLL_CTL_MOD, sock, handler, events);
+		}
+		bool remove(SOCKET sock)
+		{
+			return control(EPOLL_CTL_DEL, sock, NULL, 0);
+		}
+		bool control(int op, SOCKET sock, Handler* handler, uint32_t events)
+		{
+			struct epoll_event ev;
+
+			memset(&ev, 0, sizeof(ev));
+
+			ev.events = events;
+			ev.data.ptr = handler;
+
+			return epoll_ctl(handle, op, sock, &ev) == 0;
+		}
+		Timer addTimer(long long deadline, function<void()> func)
+		{
+			return timers.insert(pair<long long, function<void()>>(deadline, std::move(func)));
+		}
+		void cancel(Timer timer)
+		{
+			timers.erase(timer);
+		}
+		void spawn(Task<int> task)
+		{
+			Launch(std::move(task));
+		}
+		void schedule(coroutine_handle<> handle)
+		{
+			ready.push_back(handle);
+		}
+		void stop()
+		{
+			uint64_t val = 1;
+
+			stopped = true;
+
+			if (::write(notifier, &val, sizeof(val)) < 0) return;
+		}
+		void run()
+		{
+			struct epoll_event evs[256];
+
+			stopped = false;
+
+			while (!stopped)
+			{
+				int ms = -1;
+
+				if (timers.size() > 0)
+				{
+					long long delay = timers.begin()->first - Socket::GetTime();
+
+					ms = delay <= 0 ? 0 : delay < INT_MAX ? (int)(delay) : INT_MAX;
+				}
+
+				int cnt = epoll_wait(handle, evs, sizeof(evs) / sizeof(evs[0]), ms);
+
+				for (int i = 0; i < cnt; i++)
+				{
+					Handler* handler = (Handler*)(evs[i].data.ptr);
+
+					if (handler)
+					{
+						handler->process(evs[i].events);
+					}
+					else
+					{
+						uint64_t val;
+
+						while (::read(notifier, &val, sizeof(val)) > 0);
+					}
+				}
+
+				long long now = Socket::GetTime();
+
+				while (timers.size() > 0 && timers.begin()->first <= now)
+				{
+					function<void()> func = std::move(timers.begin()->second);
+
+					timers.erase(timers.begin());
+
+					func();
+				}
+
+				while (ready.size() > 0)
+				{
+					coroutine_handle<> handle = ready.front();
+
+					ready.pop_front();
+					handle.resume();
+				}
+			}
+		}
+	};
+
+	class AsyncConnect : public Reactor::Handler
+	{
+	protected:
+		struct Request
+		{
+			int code = 0;
+			bool done = false;
+			bool armed = false;
+			Command* cmd = NULL;
+			Reactor::Timer timer;
+			coroutine_handle<> waiter;
+		};
+
+		struct Awaiter
+		{
+			Request* req;
+
+			bool await_ready() const noexcept
+			{
+				return req->done;
+			}
+			void await_suspend(coroutine_handle<> handle) noexcept
+			{
+				req->waiter = handle;
+			}
+			int await_resume() const noexcept
+			{
+				return req->code;
+			}
+		};
+
+		int offset = 0;
+		int readed = 0;
+		int written = 0;
+		int timeout = 0;
+		uint32_t events = 0;
+		SOCKET sock = INVALID_SOCKET;
+
+		string output;
+		Buffer buffer;
+		Reactor* reactor;
+		shared_ptr<Request> connector;
+		deque<shared_ptr<Request>> queue;
+		vector<struct iovec> iov;
+
+		shared_ptr<Request> request(Command* cmd, int timeout)
+		{
+			shared_ptr<Request> req = make_shared<Request>();
+
+			req->cmd = cmd;
+			req->armed = true;
+			req->timer = reactor->addTimer(Socket::GetTime() + timeout, [this, req](){
+				req->armed = false;
+				fail(TIMEOUT);
+			});
+
+			return req;
+		}
+		void complete(shared_ptr<Request> req, int code)
+		{
+			if (req->armed) reactor->cancel(req->timer);
+
+			if (Command* cmd = req->cmd)
+			{
+				if (code == TIMEOUT || code == NETERR || code == NETCLOSE || code == DATAERR || code == PARAMERR)
+				{
+					cmd->reset();
+					cmd->setResult(code);
+				}
+				else
+				{
+					cmd->setResult(code);
+					cmd->detach();
+				}
+			}
+
+			req->code = code;
+			req->done = true;
+			req->armed = false;
+
+			if (req->waiter) reactor->schedule(req->waiter);
+		}
+		void fail(int code)
+		{
+			deque<shared_ptr<Request>> vec;
+			shared_ptr<Request> req = connector;
+
+			vec.swap(queue);
+			connector.reset();
+			close();
+
+			if (req) complete(req, code);
+
+			for (shared_ptr<Request>& item : vec) complete(item, code);
+		}
+		void watch(uint32_t events)
+		{
+			if (events == this->events) return;
+
+			reactor->modify(sock, this, events);
+
+			this->events = events;
+		}
+		bool flush()
+		{
+			while (written < (int)(output.length()))
+			{
+				int len = send(sock, output.c_str() + written, output.length() - written, 0);
+
+				if (len > 0)
+				{
+					written += len;
+				}
+				else if (Socket::IsSocketTimeout())
+				{
+					watch(EPOLLIN | EPOLLOUT);
+
+					return true;
+				}
+				else
+				{
+					fail(NETERR);
+
+					return false;
+				}
+			}
+
+			output.clear();
+			written = 0;
+
+			watch(EPOLLIN);
+
+			return true;
+		}
+		bool parse()
+		{
+			while (queue.size() > 0 && readed > offset)
+			{
+				int len = 0;
+				shared_ptr<Request> req = queue.front();
+				Command& cmd = *req->cmd;
+
+				cmd.src = &buffer;
+				cmd.base = offset;
+
+				if ((len = cmd.parse(buffer.str() + offset, readed - offset)) == TIMEOUT) break;
+
+				if (len == DATAERR)
+				{
+					fail(DATAERR);
+
+					return false;
+				}
+
+				offset += cmd.length;
+				queue.pop_front();
+				complete(req, len);
+			}
+
+			if (offset == readed) offset = readed = 0;
+
+			return true;
+		}
+		void receive()
+		{
+			while (true)
+			{
+				if (offset > 0 && readed >= buffer.getSize())
+				{
+					memmove(buffer.str(), buffer.str() + offset, readed - offset);
+					readed -= offset;
+					offset = 0;
+				}
+
+				char* dest = buffer.reserve(readed);
+
+				if (dest == NULL) return fail(PARAMERR);
+
+				int len = recv(sock, dest + readed, buffer.getSize() - readed, 0);
+
+				if (len > 0)
+				{
+					readed += len;
+
+					if (parse()) continue;
+
+					return;
+				}
+
+				if (len == 0) return fail(NETCLOSE);
+
+				if (Socket::IsSocketTimeout()) return;
+
+				return fail(NETERR);
+			}
+		}
+
+	public:
+		AsyncConnect(Reactor* reactor)
+		{
+			this->reactor = reactor;
+		}
+		~AsyncConnect()
+		{
+			fail(NETCLOSE);
+		}
+
+	public:
+		void close()
+		{
+			if (!Socket::IsSocketClosed(sock))
+			{
+				reactor->remove(sock);
+				Socket::SocketClose(sock);
+			}
+
+			sock = INVALID_SOCKET;
+			events = 0;
+			offset = readed = written = 0;
+			output.clear();
+		}
+		bool isClosed() const
+		{
+			return Socket::IsSocketClosed(sock);
+		}
+		void process(uint32_t events)
+		{
+			if (connector)
+			{
+				int res = FAIL;
+				socklen_t len = sizeof(res);
+				shared_ptr<Request> req = connector;
+
+				getsockopt(sock, SOL_SOCKET, SO_ERROR, (char*)(&res), &len);
+
+				if (res == 0)
+				{
+					connector.reset();
+					watch(EPOLLIN);
+					complete(req, OK);
+				}
+				else
+				{
+					fail(NETERR);
+				}
+
+				return;
+			}
+
+			if (events & (EPOLLIN | EPOLLERR | EPOLLHUP)) receive();
+
+			if ((events & EPOLLOUT) && !Socket::IsSocketClosed(sock)) flush();
+		}
+		Task<int> connect(string host, int port, string pwd = "", double timeout = 3, int memsz = BUFFER_MAXSZ)
+		{
+			u_long mode = 1;
+			struct sockaddr_in addr;
+
+			fail(NETCLOSE);
+
+			if (Socket::IsSocketClosed(sock = socket(AF_INET, SOCK_STREAM, 0))) co_return SYSERR;
+
+			this->timeout = (int)(timeout * 1000 + 0.5);
+
+			addr.sin_family = AF_INET;
+			addr.sin_port = htons(port);
+			addr.sin_addr.s_addr = inet_addr(host.c_str());
+
+			ioctlsocket(sock, FIONBIO, &mode);
+			buffer.init(memsz);
+
+			if (::connect(sock, (struct sockaddr*)(&addr), sizeof(addr)) == 0)
+			{
+				reactor->add(sock, this, events = EPOLLIN);
+			}
+			else if (errno == EINPROGRESS)
+			{
+				reactor->add(sock, this, events = EPOLLIN | EPOLLOUT);
+
+				shared_ptr<Request> req = connector = request(NULL, this->timeout);
+
+				int res = co_await Awaiter{req.get()};
+
+				if (res < 0) co_return res;
+			}
+			else
+			{
+				close();
+
+				co_return NETERR;
+			}
+
+			if (pwd.empty()) co_return OK;
+
+			Command cmd;
+
+			cmd.add("auth", pwd);
+
+			if (co_await execute(cmd) > 0) co_return OK;
+
+			close();
+
+			co_return AUTHFAIL;
+		}
+		Task<int> execute(Command& cmd)
+		{
+			if (Socket::IsSocketClosed(sock) || connector)
+			{
+				cmd.reset();
+				cmd.setResult(NETERR);
+
+				co_return NETERR;
+			}
+
+			shared_ptr<Request> req = request(&cmd, cmd.timeout > 0 ? cmd.timeout : timeout);
+
+			cmd.reset();
+			iov.clear();
+			cmd.getIovec(iov);
+
+			for (const struct iovec& item : iov) output.append((const char*)(item.iov_base), item.iov_len);
+
+			queue.push_back(req);
+
+			if (written == 0 && events == EPOLLIN) flush();
+
+			co_return co_await Awaiter{req.get()};
+		}
+		template<class DATA_TYPE, class ...ARGS>
+		Task<int> execute(DATA_TYPE val, ARGS ...args)
+		{
+			Command cmd;
+
+			cmd.add(val, args...);
+
+			co_return co_await execute(cmd);
+		}
+
+	public:
+		Task<int> ping()
+		{
+			return execute("ping");
+		}
+		Task<int> del(string key)
+		{
+			return execute("del", key);
+		}
+		Task<int> get(string key, string& val)
+		{
+			Command cmd;
+
+			cmd.add("get", key);
+
+			if (co_await execute(cmd) > 0 && cmd.getDataSize() > 0) val = cmd.get(0);
+
+			co_return cmd.getErrorCode();
+		}
+		Task<int> set(string key, string val, int timeout = 0)
+		{
+			if (timeout > 0) return execute("setex", key, timeout, val);
+
+			return execute("set", key, val);
+		}
+	};
+#endif
+
+protected:
+	class ConnectPool;
+
+	int code = 0;
+	int port = 0;
+	int memsz = 0;
+	int status = 0;
+	int timeout = 0;
+
+	string pwd;
+	string msg;
+	string host;
+	Socket sock;
+	Buffer buffer;
+	Command request;
+	vector<struct iovec> iov;
+
+	int proto = 2;
+	bool uring = false;
+	time_t utime = 0;
+	atomic<int> state{0};
+	ConnectPool* pool = NULL;
+
+	bool acquire()
+	{
+		int val = 0;
+
+		return state.compare_exchange_strong(val, 1);
+	}
+	void release(bool update = true)
+	{
+		if (update) utime = time(NULL);
+
+		state.store(0);
+
+		if (pool) pool->notify();
+	}
+	bool open(const RedisConnect& temp)
+	{
+		uring = temp.uring;
+
+		if (connect(temp.host, temp.port, temp.timeout / 1000.0, temp.memsz) && auth(temp.pwd) > 0 && (temp.proto < 3 || hello(temp.proto) > 0))
+		{
+			utime = time(NULL);
+
+			return true;
+		}
+
+		return false;
+	}
+
+public:
+	~RedisConnect()
+	{
+		close();
+	}
+
+public:
+	int getStatus() const
+	{
+		return status;
+	}
+	int getErrorCode() const
+	{
+		return code;
+	}
+	string getErrorString() const
+	{
+		return msg;
+	}
+	int getTimeout() const
+	{
+		return timeout;
+	}
+	void setTimeout(int ms)
+	{
+		timeout = ms;
+	}
+	int getProtocol() const
+	{
+		return proto;
+	}
+	Reply getReply() const
+	{
+		return request.getReply();
+	}
+	int getBufferSize() const
+	{
+		return buffer.getSize();
+	}
+	int getBufferPeakSize() const
+	{
+		return buffer.getPeakSize();
+	}
+	int getBufferMaxSize() const
+	{
+		return buffer.getMaxSize();
+	}
+	bool isUring() const
+	{
+		return sock.isUring();
+	}
+	bool setUring(bool flag)
+	{
+		return sock.setUring(uring = flag);
+	}
+
+public:
+	void close()
+	{
+		sock.close();
+		buffer.close();
+	}
+	bool reconnect()
+	{
+		if (host.empty()) return false;
+
+		return connect(host, port, timeout / 1000.0, memsz) && auth(pwd) > 0 && (proto < 3 || hello(proto) > 0);
+	}
+	int execute(Command& cmd)
+	{
+		return cmd.getResult(this, timeout);
+	}
+	int execute(Pipeline& pipe)
+	{
+		return pipe.getResult(this, timeout);
+	}
+	template<class DATA_TYPE, class ...ARGS>
+	int execute(const DATA_TYPE& val, const ARGS& ...args)
+	{
+		request.clear();
+		request.bind(val, args...);
+
+		return request.getResult(this, timeout);
+	}
+	template<class DATA_TYPE, class ...ARGS>
+	int execute(vector<string>& vec, const DATA_TYPE& val, const ARGS& ...args)
+	{
+		request.clear();
+		request.bind(val, args...);
+		request.getResult(this, timeout);
+
+		if (code > 0) request.takeDataList(vec);
+
+		return code;
+	}
+
+	bool connect(const string& host, int port, double timeout = 3, int memsz = BUFFER_MAXSZ)
+	{
+		close();
+
+		if (sock.connect(host, port, timeout))
+		{
+			sock.setUring(uring);
+
+			this->host = host;
+			this->port = port;
+			this->memsz = memsz;
+			this->timeout = (int)(timeout * 1000 + 0.5);
+
+			buffer.init(memsz);
+		}
+
+		return buffer.str() ? true : false;
+	}
+
+protected:
+	template<class DATA_TYPE, class ...ARGS>
+	int getValue(string& val, const DATA_TYPE& cmd, const ARGS& ...args)
+	{
+		request.clear();
+		request.bind(cmd, args...);
+
+		if (request.getResult(this, timeout) > 0 && request.getDataSize() > 0)
+		{
+			View data = request.getView(0);
+
+			val.assign(data.str(), data.size());
+		}
+
+		return code;
+	}
+
+public:
+	int ping()
+	{
+		return execute("ping");
+	}
+	int del(const string& key)
+	{
+		return execute("del", key);
+	}
+	int ttl(const string& key)
+	{
+		return execute("ttl", key) == OK ? status : code;
+	}
+	int hlen(const string& key)
+	{
+		return execute("hlen", key) == OK ? status : code;
+	}
+	int auth(const string& pwd)
+	{
+		this->pwd = pwd;
+
+		if (pwd.empty()) return OK;
+
+		return execute("auth", pwd);
+	}
+	int hello(int proto = 3)
+	{
+		if (execute("hello", proto) > 0) this->proto = proto;
+
+		return code;
+	}
+	int get(const string& key, string& val)
+	{
+		return getValue(val, "get", key);
+	}
+	int decr(const string& key, int val = 1)
+	{
+		return execute("decrby", key, val);
+	}
+	int incr(const string& key, int val = 1)
+	{
+		return execute("incrby", key, val);
+	}
+	int expire(const string& key, int timeout)
+	{
+		return execute("expire", key, timeout);
+	}
+	int keys(vector<string>& vec, const string& key)
+	{
+		return execute(vec, "keys", key);
+	}
+	int hdel(const string& key, const string& filed)
+	{
+		return execute("hdel", key, filed);
+	}
+	int hget(const string& key, const string& filed, string& val)
+	{
+		return getValue(val, "hget", key, filed);
+	}
+	int set(const string& key, const string& val, int timeout = 0)
+	{
+		return timeout > 0 ? execute("setex", key, timeout, val) : execute("set", key, val);
+	}
+	int hset(const string& key, const string& filed, const string& val)
+	{
+		return execute("hset", key, filed, val);
+	}
+
+public:
+	int pop(const string& key, string& val)
+	{
+		return lpop(key, val);
+	}
+	int lpop(const string& key, string& val)
+	{
+		return getValue(val, "lpop", key);
+	}
+	int rpop(const string& key, string& val)
+	{
+		return getValue(val, "rpop", key);
+	}
+	int push(const string& key, const string& val)
+	{
+		return rpush(key, val);
+	}
+	int lpush(const string& key, const string& val)
+	{
+		return execute("lpush", key, val);
+	}
+	int rpush(const string& key, const string& val)
+	{
+		return execute("rpush", key, val);
+	}
+	int range(vector<string>& vec, const string& key, int start, int end)
+	{
+		return execute(vec, "lrange", key, start, end);
+	}
+	int lrange(vector<string>& vec, const string& key, int start, int end)
+	{
+		return execute(vec, "lrange", key, start, end);
+	}
+
+public:
+	int zrem(const string& key, const string& filed)
+	{
+		return execute("zrem", key, filed);
+	}
+	int zadd(const string& key, const string& filed, int score)
+	{
+		return execute("zadd", key, score, filed);
+	}
+	int zrange(vector<string>& vec, const string& key, int start, int end, bool withscore = false)
+	{
+		return withscore ? execute(vec, "zrange", key, start, end, "withscores") : execute(vec, "zrange", key, start, end);
+	}
+	template<class FUNC> int scan(FUNC func, const string& pattern = "", int count = SCAN_COUNT, const string& type = "")
+	{
+		return iterate("scan", NULL, pattern, count, type, 1, [&](const View& key, const View&){
+			return func(key);
+		});
+	}
+	template<class FUNC> int sscan(const string& key, FUNC func, const string& pattern = "", int count = SCAN_COUNT)
+	{
+		return iterate("sscan", &key, pattern, count, "", 1, [&](const View& member, const View&){
+			return func(member);
+		});
+	}
+	template<class FUNC> int hscan(const string& key, FUNC func, const string& pattern = "", int count = SCAN_COUNT)
+	{
+		return iterate("hscan", &key, pattern, count, "", 2, func);
+	}
+	template<class FUNC> int zscan(const string& key, FUNC func, const string& pattern = "", int count = SCAN_COUNT)
+	{
+		return iterate("zscan", &key, pattern, count, "", 2, func);
+	}
+
+protected:
+	template<class FUNC> int iterate(const char* name, const string* key, const string& pattern, int count, const string& type, int step, FUNC func)
+	{
+		int idx = 0;
+		Command vec[2];
+		string cursor = "0";
+
+		auto submit = [&](Command& cmd){
+			cmd.clear();
+			cmd.add(name);
+
+			if (key) cmd.add(*key);
+
+			cmd.add(cursor);
+
+			if (pattern.length() > 0) cmd.add("match", pattern);
+			if (type.length() > 0) cmd.add("type", type);
+			if (count > 0) cmd.add("count", count);
+
+			return cmd.request(this, Socket::GetTime() + timeout, false);
+		};
+
+		if (submit(vec[0]) < 0 || vec[0].response(this, Socket::GetTime() + timeout) < 0) return code;
+
+		while (true)
+		{
+			Command& cmd = vec[idx];
+			Command& next = vec[idx ^ 1];
+			int cnt = cmd.getDataSize();
+			Reply reply = cmd.getReply();
+
+			if (reply.size() != 2 || !reply[1].isArray()) return code = DATAERR;
+
+			cursor = reply[0].toString();
+
+			bool done = cursor == "0";
+
+			cmd.detach();
+
+			if (!done && submit(next) < 0) return code;
+
+			for (int i = 1; i + step <= cnt; i += step)
+			{
+				if (!func(cmd.getView(i), step > 1 ? cmd.getView(i + 1) : View()))
+				{
+					done = true;
+
+					break;
+				}
+			}
+
+			if (cursor == "0") return OK;
+
+			if (next.response(this, Socket::GetTime() + timeout) < 0) return code;
+
+			if (done) return OK;
+
+			idx ^= 1;
+		}
+	}
+
+protected:
+	class ConnectPool
+	{
+	protected:
+		int maxsz = 0;
+		int minidle = 0;
+		int maxwait = 0;
+		int idletime = 0;
+		bool stopped = false;
+		atomic<int> count{0};
+		atomic<int> waiting{0};
+		atomic<bool> maintained{false};
+		unique_ptr<atomic<RedisConnect*>[]> slot;
+		const RedisConnect* temp;
+
+		Mutex mtx;
+		thread worker;
+		condition_variable cv;
+		condition_variable timer;
+
+		RedisConnect* get(size_t shard)
+		{
+			RedisConnect* idle = NULL;
+
+			for (int i = 0; i < maxsz; i++)
+			{
+				RedisConnect* redis = slot[(shard + i) % maxsz].load();
+
+				if (redis == NULL || !redis->acquire()) continue;
+
+				if (!redis->sock.isClosed())
+				{
+					if (idle) idle->release(false);
+
+					return redis;
+				}
+
+				if (idle)
+				{
+					redis->release(false);
+				}
+				else
+				{
+					idle = redis;
+				}
+			}
+
+			return idle ? idle : create();
+		}
+		RedisConnect* create()
+		{
+			if (count.fetch_add(1) >= maxsz)
+			{
+				count.fetch_sub(1);
+
+				return NULL;
+			}
+
+			RedisConnect* redis = new RedisConnect();
+
+			redis->pool = this;
+			redis->acquire();
+
+			for (int i = 0; true; i = (i + 1) % maxsz)
+			{
+				RedisConnect* tmp = NULL;
+
+				if (slot[i].compare_exchange_strong(tmp, redis)) return redis;
+			}
+		}
+		void maintain()
+		{
+			int active = 0;
+			time_t now = time(NULL);
+			vector<RedisConnect*> vec;
+			const RedisConnect& temp = *this->temp;
+
+			for (int i = 0; i < maxsz; i++)
+			{
+				RedisConnect* redis = slot[i].load();
+
+				if (redis == NULL) continue;
+
+				if (!redis->acquire())
+				{
+					active++;
+
+					continue;
+				}
+
+				if (!redis->sock.isClosed())
+				{
+					if (active >= minidle && redis->utime + idletime <= now)
+					{
+						redis->close();
+					}
+					else if (redis->ping() > 0 || redis->reconnect())
+					{
+						active++;
+					}
+					else
+					{
+						redis->close();
+					}
+				}
+
+				if (redis->sock.isClosed() && active < minidle)
+				{
+					vec.push_back(redis);
+				}
+				else
+				{
+					redis->release(false);
+				}
+			}
+
+			for (RedisConnect* redis : vec)
+			{
+				if (active < minidle && (redis->host.empty() ? redis->open(temp) : redis->reconnect())) active++;
+
+				redis->release(false);
+			}
+
+			while (active < minidle && temp.port > 0)
+			{
+				RedisConnect* redis = create();
+
+				if (redis == NULL) break;
+
+				if (redis->open(temp)) active++;
+
+				redis->release(false);
+
+				if (redis->sock.isClosed()) break;
+			}
+		}
+
+	public:
+		ConnectPool(const RedisConnect* temp)
+		{
+			this->temp = temp;
+		}
+		~ConnectPool()
+		{
+			stop();
+
+			for (int i = 0; i < maxsz; i++) delete slot[i].load();
+		}
+
+	public:
+		bool init(int maxsz, int minidle, int maxwait)
+		{
+			if (maxsz <= 0) maxsz = POOL_MAXLEN;
+
+			if (minidle > maxsz) minidle = maxsz;
+
+			this->minidle = minidle;
+			this->maxwait = maxwait;
+
+			if (slot && (count > 0 || maxsz == this->maxsz)) return false;
+
+			slot.reset(new atomic<RedisConnect*>[maxsz]);
+
+			for (int i = 0; i < maxsz; i++) slot[i].store(NULL);
+
+			this->maxsz = maxsz;
+
+			return true;
+		}
+		bool inited() const
+		{
+			return slot ? true : false;
+		}
+		bool isMaintained() const
+		{
+			return maintained.load();
+		}
+		void start(int interval, int idletime)
+		{
+			Locker lk(mtx);
+
+			if (worker.joinable()) return;
+
+			this->idletime = idletime;
+			this->maintained = true;
+
+			worker = thread([this, interval](){
+				unique_lock<Mutex> lk(mtx);
+
+				while (!timer.wait_for(lk, chrono::seconds(interval), [this](){ return stopped; }))
+				{
+					lk.unlock();
+					maintain();
+					lk.lock();
+				}
+			});
+		}
+		void stop()
+		{
+			{
+				Locker lk(mtx);
+				stopped = true;
+				timer.notify_all();
+			}
+
+			if (worker.joinable()) worker.join();
+
+			maintained = false;
+		}
+		void notify()
+		{
+			if (waiting.load() > 0)
+			{
+				Locker lk(mtx);
+				cv.notify_one();
+			}
+		}
+		shared_ptr<RedisConnect> instance(RedisConnect* redis)
+		{
+			if (redis == NULL)
+			{
+				shared_ptr<RedisConnect> redis = make_shared<RedisConnect>();
+
+				redis->code = SYSBUSY;
+				redis->msg = GetErrorString(SYSBUSY);
+
+				return redis;
+			}
+
+			if (redis->sock.isClosed() || (redis->utime + 60 <= time(NULL) && !isMaintained()))
+			{
+				if (redis->host.empty())
+				{
+					redis->open(*temp);
+				}
+				else
+				{
+					if (redis->ping() < 0) redis->reconnect();
+				}
+			}
+
+			return shared_ptr<RedisConnect>(redis, [](RedisConnect* redis){
+				redis->release();
+			});
+		}
+		RedisConnect* acquire(size_t shard)
+		{
+			RedisConnect* redis = get(shard);
+
+			if (redis || maxwait <= 0) return redis;
+
+			auto deadline = chrono::steady_clock::now() + chrono::milliseconds(maxwait);
+			unique_lock<Mutex> lk(mtx);
+
+			waiting++;
+
+			while ((redis = get(shard)) == NULL)
+			{
+				if (cv.wait_until(lk, deadline) == cv_status::timeout)
+				{
+					redis = get(shard);
+
+					break;
+				}
+			}
+
+			waiting--;
+
+			return redis;
+		}
+
+	public:
+		int getMaxSize() const
+		{
+			return maxsz;
+		}
+		int getMinIdle() const
+		{
+			return minidle;
+		}
+		int getMaxWait() const
+		{
+			return maxwait;
+		}
+		int getSize() const
+		{
+			return count.load();
+		}
+	};
+	static RedisConnect* GetTemplate()
+	{
+		static RedisConnect redis;
+		return &redis;
+	}
+	static ConnectPool* GetConnectPool()
+	{
+		static ConnectPool pool(GetTemplate());
+		return &pool;
 	}
-	bool connect(const string& host, int port, int timeout = 3, int memsz = 1024 * 1024)
+
+public:
+	class NodeGroup
+	{
+	protected:
+		struct Node
+		{
+			string name;
+			unique_ptr<RedisConnect> temp;
+			unique_ptr<ConnectPool> pool;
+		};
+
+		struct Batch
+		{
+			int code;
+			Node* node;
+			Pipeline pipe;
+			vector<vector<int>> index;
+			shared_ptr<RedisConnect> redis;
+		};
+
+		static void Startup()
+		{
+#ifndef _MSC_VER
+			signal(SIGPIPE, SIG_IGN);
+#else
+			WSADATA data; WSAStartup(MAKEWORD(2, 2), &data);
+#endif
+		}
+		static void Open(Node* node, const string& host, int port, const string& pwd, int timeout, int memsz, int maxlen, bool uring = false)
+		{
+			if (!node->temp)
+			{
+				node->temp.reset(new RedisConnect());
+				node->pool.reset(new ConnectPool(node->temp.get()));
+			}
+
+			RedisConnect& temp = *node->temp;
+
+			temp.pwd = pwd;
+			temp.host = host;
+			temp.port = port;
+			temp.uring = uring;
+			temp.memsz = memsz;
+			temp.timeout = timeout;
+
+			node->name = host + ":" + to_string(port);
+			node->pool->init(maxlen, 0, timeout);
+		}
+		shared_ptr<RedisConnect> instance(Node* node)
+		{
+			static thread_local size_t shard = hash<thread::id>()(this_thread::get_id());
+
+			return node->pool->instance(node->pool->acquire(shard));
+		}
+		virtual Node* locate(const string& key, int& slot) = 0;
+		virtual bool retry(const Command&)
+		{
+			return false;
+		}
+		int scatter(vector<Batch>& vec, const char* name, const vector<string>& keys, const vector<string>* vals)
+		{
+			map<Node*, int> pos;
+			map<pair<Node*, int>, vector<int>> group;
+
+			for (int i = 0; i < (int)(keys.size()); i++)
+			{
+				int slot = 0;
+				Node* node = locate(keys[i], slot);
+
+				if (node == NULL) return NOTFOUND;
+
+				group[pair<Node*, int>(node, slot)].push_back(i);
+			}
+
+			for (auto& item : group)
+			{
+				Node* node = item.first.first;
+				auto it = pos.insert(pair<Node*, int>(node, vec.size())).first;
+
+				if (it->second == (int)(vec.size()))
+				{
+					vec.push_back(Batch());
+					vec.back().node = node;
+				}
+
+				Batch& batch = vec[it->second];
+
+				batch.pipe.vec.push_back(Command());
+				batch.index.push_back(item.second);
+
+				Command& cmd = batch.pipe.vec.back();
+
+				cmd.add(name);
+
+				for (int idx : item.second)
+				{
+					cmd.bind(keys[idx]);
+
+					if (vals) cmd.bind((*vals)[idx]);
+				}
+			}
+
+			for (Batch& batch : vec)
+			{
+				batch.redis = instance(batch.node);
+
+				if ((batch.code = batch.redis->code) == SYSBUSY)
+				{
+					for (Command& cmd : batch.pipe.vec) cmd.setResult(SYSBUSY);
+				}
+				else
+				{
+					batch.code = batch.pipe.request(batch.redis.get(), Socket::GetTime() + batch.node->temp->timeout, vec.size() == 1);
+				}
+			}
+
+			for (Batch& batch : vec)
+			{
+				int timeout = batch.node->temp->timeout;
+
+				if (batch.code >= 0) batch.pipe.response(batch.redis.get(), Socket::GetTime() + timeout, timeout);
+			}
+
+			int res = OK;
+
+			for (Batch& batch : vec)
+			{
+				for (Command& cmd : batch.pipe.vec)
+				{
+					int code = retry(cmd) ? execute(cmd) : cmd.getErrorCode();
+
+					if (code < 0 && code != NOTFOUND) res = code;
+				}
+			}
+
+			return res;
+		}
+		int count(const char* name, const vector<string>& keys)
+		{
+			int cnt = 0;
+			vector<Batch> vec;
+
+			int res = scatter(vec, name, keys, NULL);
+
+			if (res < 0) return res;
+
+			for (Batch& batch : vec)
+			{
+				for (Command& cmd : batch.pipe.vec) cnt += cmd.getStatus();
+			}
+
+			return cnt;
+		}
+
+	public:
+		virtual ~NodeGroup()
+		{
+		}
+
+	public:
+		virtual int execute(Command& cmd) = 0;
+
+		template<class DATA_TYPE, class ...ARGS>
+		int execute(const DATA_TYPE& val, const ARGS& ...args)
+		{
+			Command cmd;
+
+			cmd.add(val, args...);
+
+			return execute(cmd);
+		}
+
+	public:
+		int del(const string& key)
+		{
+			return execute("del", key);
+		}
+		int get(const string& key, string& val)
+		{
+			Command cmd;
+
+			cmd.add("get", key);
+
+			if (execute(cmd) > 0 && cmd.getDataSize() > 0) val = cmd.get(0);
+
+			return cmd.getErrorCode();
+		}
+		int set(const string& key, const string& val, int timeout = 0)
+		{
+			if (timeout > 0) return execute("setex", key, timeout, val);
+
+			return execute("set", key, val);
+		}
+
+	public:
+		int del(const vector<string>& keys)
+		{
+			return count("del", keys);
+		}
+		int exists(const vector<string>& keys)
+		{
+			return count("exists", keys);
+		}
+		int mget(const vector<string>& keys, vector<string>& vals)
+		{
+			vector<Batch> vec;
+
+			int res = scatter(vec, "mget", keys, NULL);
+
+			if (res < 0) return res;
+
+			vals.clear();
+			vals.resize(keys.size());
+
+			for (Batch& batch : vec)
+			{
+				for (size_t i = 0; i < batch.index.size(); i++)
+				{
+					Command& cmd = batch.pipe.vec[i];
+					const vector<int>& index = batch.index[i];
+
+					for (int j = 0; j < (int)(index.size()) && j < cmd.getDataSize(); j++)
+					{
+						View data = cmd.getView(j);
+
+						vals[index[j]].assign(data.str(), data.size());
+					}
+				}
+			}
+
+			return keys.size();
+		}
+		int mset(const vector<string>& keys, const vector<string>& vals)
+		{
+			if (keys.size() != vals.size()) return PARAMERR;
+
+			vector<Batch> vec;
+
+			return scatter(vec, "mset", keys, &vals);
+		}
+	};
+
+	class Cluster : public NodeGroup
+	{
+	protected:
+		using NodeGroup::instance;
+
+		int maxsz = 0;
+		int memsz = 0;
+		int timeout = 0;
+		bool uring = false;
+		string pwd;
+		string host;
+		int port = 0;
+
+		Mutex mtx;
+		atomic<long long> utime{0};
+		map<string, unique_ptr<Node>> nodes;
+		unique_ptr<atomic<Node*>[]> slots;
+
+		Node* getNode(const string& host, int port)
+		{
+			Locker lk(mtx);
+			unique_ptr<Node>& node = nodes[host + ":" + to_string(port)];
+
+			if (node) return node.get();
+
+			node.reset(new Node());
+
+			Open(node.get(), host, port, pwd, timeout, memsz, maxsz, uring);
+
+			return node.get();
+		}
+		Node* getNode(const string& addr)
+		{
+			size_t pos = addr.rfind(':');
+
+			if (pos == string::npos) return NULL;
+
+			string host = addr.substr(0, pos);
+
+			return getNode(host.empty() ? this->host : host, atoi(addr.c_str() + pos + 1));
+		}
+		Node* getNode(const View& key)
+		{
+			if (key.isNull()) return getNode(host, port);
+
+			Node* node = slots[GetSlot(key.str(), key.size())].load();
+
+			if (node) return node;
+
+			refresh();
+
+			return slots[GetSlot(key.str(), key.size())].load();
+		}
+		Node* locate(const string& key, int& slot)
+		{
+			Node* node = getNode(View(key.c_str(), key.length()));
+
+			slot = GetSlot(key.c_str(), key.length());
+
+			return node ? node : getNode(host, port);
+		}
+		bool retry(const Command& cmd)
+		{
+			int code = cmd.getErrorCode();
+
+			return code == NETERR || code == NETCLOSE || (code == FAIL && (cmd.msg.compare(0, 6, "MOVED ") == 0 || cmd.msg.compare(0, 4, "ASK ") == 0));
+		}
+
+	public:
+		using NodeGroup::execute;
+
+	public:
+		static unsigned short CRC16(const char* data, int len)
+		{
+			static const vector<unsigned short> table = [](){
+				vector<unsigned short> vec(256);
+
+				for (int i = 0; i < 256; i++)
+				{
+					unsigned short crc = i << 8;
+
+					for (int j = 0; j < 8; j++) crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+
+					vec[i] = crc;
+				}
+
+				return vec;
+			}();
+
+			unsigned short crc = 0;
+
+			for (int i = 0; i < len; i++) crc = (crc << 8) ^ table[((crc >> 8) ^ (unsigned char)(data[i])) & 0xFF];
+
+			return crc;
+		}
+		static int GetSlot(const char* key, int len)
+		{
+			key = GetHashTag(key, len);
+
+			return CRC16(key, len) & (CLUSTER_SLOTS - 1);
+		}
+
+	public:
+		bool init(const string& host, int port, const string& pwd = "", double timeout = 3, int memsz = BUFFER_MAXSZ, int maxlen = POOL_MAXLEN)
+		{
+			Startup();
+
+			{
+				Locker lk(mtx);
+
+				if (slots) return false;
+
+				this->pwd = pwd;
+				this->host = host;
+				this->port = port;
+				this->memsz = memsz;
+				this->maxsz = maxlen;
+				this->timeout = (int)(timeout * 1000 + 0.5);
+
+				slots.reset(new atomic<Node*>[CLUSTER_SLOTS]);
+
+				for (int i = 0; i < CLUSTER_SLOTS; i++) slots[i].store(NULL);
+			}
+
+			return refresh(true);
+		}
+		bool inited() const
+		{
+			return slots ? true : false;
+		}
+		void setUring(bool flag)
+		{
+			uring = flag;
+		}
+		bool refresh(bool force = false)
+		{
+			long long now = Socket::GetTime();
+			long long last = utime.load();
+
+			if (force)
+			{
+				utime = now;
+			}
+			else if (last + CLUSTER_REFRESH > now || !utime.compare_exchange_strong(last, now))
+			{
+				return false;
+			}
+
+			vector<Node*> vec;
+
+			{
+				Locker lk(mtx);
+
+				for (auto& item : nodes) vec.push_back(item.second.get());
+			}
+
+			if (vec.empty()) vec.push_back(getNode(host, port));
+
+			for (Node* node : vec)
+			{
+				string msg;
+				shared_ptr<RedisConnect> redis = instance(node);
+
+				if (redis->getValue(msg, "cluster", "nodes") < 0) continue;
+
+				stringstream ss(msg);
+				string line;
+
+				while (getline(ss, line))
+				{
+					vector<string> args;
+					stringstream tmp(line);
+
+					for (string str; tmp >> str; ) args.push_back(str);
+
+					if (args.size() < 9) continue;
+
+					string flag = "," + args[2] + ",";
+
+					if (flag.find(",master,") == string::npos || flag.find(",fail,") != string::npos) continue;
+
+					Node* owner = getNode(args[1].substr(0, args[1].find('@')));
+
+					if (owner == NULL) continue;
+
+					for (size_t i = 8; i < args.size(); i++)
+					{
+						const string& range = args[i];
+
+						if (range[0] == '[') continue;
+
+						size_t pos = range.find('-');
+						int start = atoi(range.c_str());
+						int end = pos == string::npos ? start : atoi(range.c_str() + pos + 1);
+
+						while (start <= end && start < CLUSTER_SLOTS) slots[start++].store(owner);
+					}
+				}
+
+				return true;
+			}
+
+			return false;
+		}
+		shared_ptr<RedisConnect> instance(const string& key)
+		{
+			Node* node = getNode(View(key.c_str(), key.length()));
+
+			return node ? instance(node) : instance(getNode(host, port));
+		}
+		int execute(Command& cmd)
+		{
+			int res = 0;
+			bool asking = false;
+			View key = cmd.getArgument(1);
+			Node* node = getNode(key);
+
+			for (int i = 0; i < CLUSTER_REDIRECT; i++)
+			{
+				if (node == NULL) node = getNode(host, port);
+
+				shared_ptr<RedisConnect> redis = instance(node);
+
+				if (redis->code == SYSBUSY)
+				{
+					cmd.reset();
+					cmd.setResult(SYSBUSY);
+
+					return SYSBUSY;
+				}
+
+				if (asking && redis->execute("asking") < 0) return redis->code;
+
+				if ((res = redis->execute(cmd)) == NETERR || res == NETCLOSE)
+				{
+					refresh();
+					node = getNode(key);
+					asking = false;
+
+					continue;
+				}
+
+				if (res != FAIL)
+				{
+					cmd.detach();
+
+					return res;
+				}
+
+				const string& msg = cmd.getErrorString();
+
+				if (msg.compare(0, 6, "MOVED ") == 0)
+				{
+					int slot = atoi(msg.c_str() + 6);
+
+					node = getNode(msg.substr(msg.rfind(' ') + 1));
+
+					if (node && slot >= 0 && slot < CLUSTER_SLOTS) slots[slot].store(node);
+
+					asking = false;
+				}
+				else if (msg.compare(0, 4, "ASK ") == 0)
+				{
+					node = getNode(msg.substr(msg.rfind(' ') + 1));
+
+					asking = true;
+				}
+				else
+				{
+					return res;
+				}
+			}
+
+			return res;
+		}
+	};
+
+	class ShardGroup : public NodeGroup
 	{
-		close();
+	protected:
+		using NodeGroup::instance;
+
+		struct Node : public NodeGroup::Node
+		{
+			int weight;
+			bool removed;
+		};
+
+		typedef vector<pair<unsigned, Node*>> Ring;
+
+		Mutex mtx;
+		vector<unique_ptr<Node>> nodes;
+		vector<unique_ptr<Ring>> rings;
+		atomic<const Ring*> ring{NULL};
+
+		void rebuild()
+		{
+			Ring* tmp = new Ring();
+
+			for (unique_ptr<Node>& node : nodes)
+			{
+				if (node->removed) continue;
+
+				for (int i = 0; i < node->weight * SHARD_POINTS; i++)
+				{
+					string name = node->name + "-" + to_string(i);
+
+					tmp->push_back(pair<unsigned, Node*>(Hash(name.c_str(), name.length()), node.get()));
+				}
+			}
+
+			sort(tmp->begin(), tmp->end(), [](const pair<unsigned, Node*>& a, const pair<unsigned, Node*>& b){
+				return a.first < b.first;
+			});
+
+			rings.push_back(unique_ptr<Ring>(tmp));
+			ring.store(tmp);
+		}
+		Node* getNode(const char* key, int len) const
+		{
+			const Ring* ring = this->ring.load();
+
+			if (ring == NULL || ring->empty()) return NULL;
+
+			key = GetHashTag(key, len);
+
+			unsigned val = Hash(key, len);
+
+			auto it = upper_bound(ring->begin(), ring->end(), val, [](unsigned val, const pair<unsigned, Node*>& item){
+				return val < item.first;
+			});
+
+			return it == ring->end() ? ring->front().second : it->second;
+		}
+		NodeGroup::Node* locate(const string& key, int& slot)
+		{
+			slot = 0;
+
+			return getNode(key.c_str(), key.length());
+		}
+
+	public:
+		using NodeGroup::execute;
+
+	public:
+		static unsigned Hash(const char* data, int len)
+		{
+			unsigned val = 2166136261U;
+
+			for (int i = 0; i < len; i++) val = (val ^ (unsigned char)(data[i])) * 16777619U;
+
+			val ^= val >> 16;
+			val *= 0x85EBCA6BU;
+			val ^= val >> 13;
+			val *= 0xC2B2AE35U;
+			val ^= val >> 16;
+
+			return val;
+		}
+
+	public:
+		bool add(const string& host, int port, const string& pwd = "", int weight = 1, double timeout = 3, int memsz = BUFFER_MAXSZ, int maxlen = POOL_MAXLEN)
+		{
+			Startup();
+
+			Locker lk(mtx);
+			Node* node = NULL;
+			string name = host + ":" + to_string(port);
+
+			if (weight <= 0) return false;
+
+			for (unique_ptr<Node>& item : nodes)
+			{
+				if (item->name == name) node = item.get();
+			}
+
+			if (node && !node->removed) return false;
+
+			if (node == NULL) nodes.push_back(unique_ptr<Node>(node = new Node()));
+
+			Open(node, host, port, pwd, (int)(timeout * 1000 + 0.5), memsz, maxlen);
+
+			node->weight = weight;
+			node->removed = false;
+
+			rebuild();
+
+			return true;
+		}
+		bool remove(const string& host, int port)
+		{
+			Locker lk(mtx);
+			string name = host + ":" + to_string(port);
+
+			for (unique_ptr<Node>& node : nodes)
+			{
+				if (node->name == name && !node->removed)
+				{
+					node->removed = true;
+
+					rebuild();
+
+					return true;
+				}
+			}
+
+			return false;
+		}
+		int size()
+		{
+			int cnt = 0;
+			Locker lk(mtx);
+
+			for (unique_ptr<Node>& node : nodes)
+			{
+				if (!node->removed) cnt++;
+			}
+
+			return cnt;
+		}
+		string getNodeName(const string& key) const
+		{
+			Node* node = getNode(key.c_str(), key.length());
+
+			return node ? node->name : "";
+		}
+		shared_ptr<RedisConnect> instance(const string& key)
+		{
+			Node* node = getNode(key.c_str(), key.length());
+
+			if (node) return NodeGroup::instance(node);
+
+			shared_ptr<RedisConnect> redis = make_shared<RedisConnect>();
+
+			redis->code = NOTFOUND;
+			redis->msg = GetErrorString(NOTFOUND);
+
+			return redis;
+		}
+		int execute(Command& cmd)
+		{
+			View key = cmd.getArgument(1);
+			shared_ptr<RedisConnect> redis = instance(key.toString());
+
+			if (redis->code == SYSBUSY || redis->code == NOTFOUND)
+			{
+				cmd.reset();
+				cmd.setResult(redis->code);
+
+				return redis->code;
+			}
+
+			int res = redis->execute(cmd);
+
+			cmd.detach();
+
+			return res;
+		}
+	};
+
+	class ReplicaSet : public NodeGroup
+	{
+	protected:
+		using NodeGroup::instance;
+
+		struct Node : public NodeGroup::Node
+		{
+			atomic<bool> usable{true};
+			atomic<long long> latency{0};
+		};
+
+		int maxsz = 0;
+		int memsz = 0;
+		int maxlag = 0;
+		int timeout = 0;
+		string pwd;
+
+		Mutex mtx;
+		thread worker;
+		bool stopped = false;
+		condition_variable timer;
+		Node* primary = NULL;
+		atomic<long long> utime{0};
+		vector<unique_ptr<Node>> nodes;
+		vector<unique_ptr<vector<Node*>>> lists;
+		atomic<const vector<Node*>*> replicas{NULL};
+
+		atomic<int> budget{0};
+		atomic<int> percentile{0};
+		atomic<long long> delay{0};
+		atomic<long long> credit{0};
+		atomic<long long> hedged{0};
+		atomic<long long> won{0};
+		atomic<long long> histogram[HEDGE_BUCKETS];
+
+		static long long GetMicroTime()
+		{
+			return chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+		}
+		Node* create(const string& host, int port)
+		{
+			Node* node = new Node();
+			string name = host + ":" + to_string(port);
+
+			for (unique_ptr<Node>& item : nodes)
+			{
+				if (item->name == name)
+				{
+					delete node;
+
+					return item.get();
+				}
+			}
+
+			nodes.push_back(unique_ptr<Node>(node));
+
+			Open(node, host, port, pwd, timeout, memsz, maxsz);
+
+			return node;
+		}
+		void publish()
+		{
+			vector<Node*>* vec = new vector<Node*>();
+
+			for (unique_ptr<Node>& node : nodes)
+			{
+				if (node.get() != primary) vec->push_back(node.get());
+			}
+
+			lists.push_back(unique_ptr<vector<Node*>>(vec));
+			replicas.store(vec);
+		}
+		void update(Node* node, long long cost)
+		{
+			long long val = node->latency.load();
+
+			node->latency.store(val > 0 ? val + (cost - val) / REPLICA_EWMA : cost);
+		}
+		Node* select(Node* skip = NULL)
+		{
+			Node* res = NULL;
+			const vector<Node*>* vec = replicas.load();
+
+			if (vec == NULL) return primary;
+
+			for (Node* node : *vec)
+			{
+				if (node == skip || !node->usable.load()) continue;
+
+				if (res == NULL || node->latency.load() < res->latency.load()) res = node;
+			}
+
+			return res ? res : primary;
+		}
+		void record(long long cost)
+		{
+			int idx = 0;
+
+			while (idx + 1 < HEDGE_BUCKETS && cost >= (4LL << (idx / 4)) + (idx % 4 + 1) * (1LL << (idx / 4))) idx++;
+
+			histogram[idx]++;
+		}
+		void estimate()
+		{
+			long long sum = 0;
+			long long cnt[HEDGE_BUCKETS];
+
+			for (int i = 0; i < HEDGE_BUCKETS; i++) sum += (cnt[i] = histogram[i].exchange(histogram[i].load() / 2));
+
+			if (sum < HEDGE_MINCNT) return;
+
+			long long pos = sum * percentile.load(memory_order_relaxed) / 100;
+
+			for (int i = 0; i < HEDGE_BUCKETS; i++)
+			{
+				if ((pos -= cnt[i]) < 0)
+				{
+					delay = (4LL << (i / 4)) + (i % 4 + 1) * (1LL << (i / 4));
+
+					return;
+				}
+			}
+		}
+		static int Wait(struct pollfd* fds, int cnt, long long us)
+		{
+#ifndef _MSC_VER
+			struct timespec ts;
+
+			ts.tv_sec = us / 1000000;
+			ts.tv_nsec = us % 1000000 * 1000;
+
+			return ppoll(fds, cnt, &ts, NULL);
+#else
+			return poll(fds, cnt, (int)((us + 999) / 1000));
+#endif
+		}
+		int hedge(Node* node, Command& cmd)
+		{
+			long long start = GetMicroTime();
+			shared_ptr<RedisConnect> redis = instance(node);
+
+			if (redis->code == SYSBUSY) return execute(node, cmd);
+
+			long long deadline = Socket::GetTime() + (cmd.timeout > 0 ? cmd.timeout : timeout);
+
+			if (cmd.request(redis.get(), deadline, false) < 0) return execute(node, cmd);
+
+			struct pollfd fds[2];
+
+			memset(fds, 0, sizeof(fds));
+
+			fds[0].events = POLLIN;
+			fds[0].fd = redis->sock.getHandle();
+
+			int res = Wait(fds, 1, delay.load());
+
+			if (res == 0 && credit.load() >= 100)
+			{
+				Node* other = select(node);
+				shared_ptr<RedisConnect> backup = instance(other);
+
+				if (backup->code != SYSBUSY && (credit -= 100) >= 0)
+				{
+					Command tmp = cmd;
+
+					hedged++;
+
+					if (tmp.request(backup.get(), deadline, false) >= 0)
+					{
+						long long now = GetMicroTime();
+
+						fds[1].events = POLLIN;
+						fds[1].fd = backup->sock.getHandle();
+
+						while ((res = Wait(fds, 2, max(deadline - Socket::GetTime(), 0LL) * 1000)) < 0 && Socket::IsSocketTimeout()) continue;
+
+						if (res > 0 && fds[1].revents && !fds[0].revents)
+						{
+							won++;
+
+							res = tmp.response(backup.get(), deadline);
+
+							tmp.detach();
+							redis->sock.close();
+
+							update(node, GetMicroTime() - start);
+							update(other, GetMicroTime() - now);
+							record(GetMicroTime() - start);
+
+							cmd = std::move(tmp);
+
+							return res;
+						}
+
+						backup->sock.close();
+					}
+				}
+			}
+
+			res = cmd.response(redis.get(), deadline);
+
+			cmd.detach();
+
+			if (res == TIMEOUT || res == NETERR || res == NETCLOSE)
+			{
+				update(node, (long long)(timeout) * 1000);
+			}
+			else
+			{
+				update(node, GetMicroTime() - start);
+				record(GetMicroTime() - start);
+			}
+
+			return res;
+		}
+		NodeGroup::Node* locate(const string&, int& slot)
+		{
+			slot = 0;
+
+			return primary;
+		}
+		int execute(Node* node, Command& cmd, bool readonly = false)
+		{
+			if (readonly && percentile.load(memory_order_relaxed) > 0)
+			{
+				if ((credit += budget.load(memory_order_relaxed)) > HEDGE_BURST * 100) credit = HEDGE_BURST * 100;
+
+				if (delay.load() > 0) return hedge(node, cmd);
+			}
+
+			long long start = GetMicroTime();
+			shared_ptr<RedisConnect> redis = instance(node);
+
+			if (redis->code == SYSBUSY)
+			{
+				cmd.reset();
+				cmd.setResult(SYSBUSY);
+
+				return SYSBUSY;
+			}
+
+			int res = redis->execute(cmd);
+
+			cmd.detach();
+
+			if (res == TIMEOUT || res == NETERR || res == NETCLOSE)
+			{
+				update(node, (long long)(timeout) * 1000);
+			}
+			else
+			{
+				update(node, GetMicroTime() - start);
+
+				if (readonly && percentile.load(memory_order_relaxed) > 0) record(GetMicroTime() - start);
+			}
+
+			return res;
+		}
+
+	public:
+		using NodeGroup::execute;
+
+	public:
+		static bool IsReadOnly(const Command& cmd)
+		{
+			static const char* const list[] = {
+				"bitcount", "bitpos", "dbsize", "dump", "exists", "geodist", "geohash", "geopos",
+				"georadius_ro", "georadiusbymember_ro", "geosearch", "get", "getbit", "getrange",
+				"hexists", "hget", "hgetall", "hkeys", "hlen", "hmget", "hrandfield", "hscan",
+				"hstrlen", "hvals", "keys", "lindex", "llen", "lpos", "lrange", "mget", "pfcount",
+				"pttl", "randomkey", "scan", "scard", "sdiff", "sinter", "sismember", "smembers",
+				"smismember", "srandmember", "sscan", "strlen", "substr", "sunion", "ttl", "type",
+				"xlen", "xrange", "xread", "xrevrange", "zcard", "zcount", "zlexcount", "zmscore",
+				"zrandmember", "zrange", "zrangebylex", "zrangebyscore", "zrank", "zrevrange",
+				"zrevrangebylex", "zrevrangebyscore", "zrevrank", "zscan", "zscore"
+			};
+
+			char name[32];
+			View view = cmd.getArgument(0);
+			const int cnt = sizeof(list) / sizeof(list[0]);
+
+			if (view.isNull() || view.size() >= (int)(sizeof(name))) return false;
+
+			for (int i = 0; i < view.size(); i++) name[i] = tolower((unsigned char)(view.str()[i]));
+
+			name[view.size()] = 0;
+
+			auto it = lower_bound(list, list + cnt, (const char*)(name), [](const char* a, const char* b){
+				return strcmp(a, b) < 0;
+			});
+
+			return it < list + cnt && strcmp(*it, name) == 0;
+		}
+
+	public:
+		ReplicaSet()
+		{
+			for (int i = 0; i < HEDGE_BUCKETS; i++) histogram[i].store(0);
+		}
+		~ReplicaSet()
+		{
+			{
+				Locker lk(mtx);
+				stopped = true;
+				timer.notify_all();
+			}
 
-		if (sock.connect(host, port, timeout))
+			if (worker.joinable()) worker.join();
+		}
+		bool init(const string& host, int port, const string& pwd = "", double timeout = 3, int memsz = BUFFER_MAXSZ, int maxlen = POOL_MAXLEN, int maxlag = 10)
 		{
-			sock.setSendTimeout(SOCKET_TIMEOUT);
-			sock.setRecvTimeout(SOCKET_TIMEOUT);
+			Startup();
 
-			this->host = host;
-			this->port = port;
+			Locker lk(mtx);
+
+			if (primary) return false;
+
+			this->pwd = pwd;
 			this->memsz = memsz;
-			this->timeout = timeout;
-			this->buffer = new char[memsz + 1];
-		}
+			this->maxsz = maxlen;
+			this->maxlag = maxlag;
+			this->timeout = (int)(timeout * 1000 + 0.5);
 
-		return buffer ? true : false;
-	}
+			primary = create(host, port);
 
-public:
-	int ping()
-	{
-		return execute("ping");
-	}
-	int del(const string& key)
-	{
-		return execute("del", key);
-	}
-	int ttl(const string& key)
-	{
-		return execute("ttl", key) == OK ? status : code;
-	}
-	int hlen(const string& key)
-	{
-		return execute("hlen", key) == OK ? status : code;
-	}
-	int auth(const string& pwd)
-	{
-		this->pwd = pwd;
+			publish();
 
-		if (pwd.empty()) return OK;
+			worker = thread([this](){
+				int interval = REPLICA_REFRESH;
+				unique_lock<Mutex> lk(mtx);
 
-		return execute("auth", pwd);
-	}
-	int get(const string& key, string& val)
-	{
-		vector<string> vec;
+				do
+				{
+					lk.unlock();
+					refresh(true);
+					lk.lock();
+				}
+				while (!timer.wait_for(lk, chrono::milliseconds(interval), [this](){ return stopped; }));
+			});
 
-		if (execute(vec, "get", key) <= 0) return code;
+			return true;
+		}
+		bool add(const string& host, int port)
+		{
+			Locker lk(mtx);
 
-		val = vec[0];
+			if (primary == NULL) return false;
 
-		return code;
-	}
-	int decr(const string& key, int val = 1)
-	{
-		return execute("decrby", key, val);
-	}
-	int incr(const string& key, int val = 1)
-	{
-		return execute("incrby", key, val);
-	}
-	int expire(const string& key, int timeout)
-	{
-		return execute("expire", key, timeout);
-	}
-	int keys(vector<string>& vec, const string& key)
-	{
-		return execute(vec, "keys", key);
-	}
-	int hdel(const string& key, const string& filed)
-	{
-		return execute("hdel", key, filed);
-	}
-	int hget(const string& key, const string& filed, string& val)
-	{
-		vector<string> vec;
+			size_t cnt = nodes.size();
 
-		if (execute(vec, "hget", key, filed) <= 0) return code;
+			if (create(host, port) == primary || nodes.size() == cnt) return false;
 
-		val = vec[0];
+			publish();
 
-		return code;
-	}
-	int set(const string& key, const string& val, int timeout = 0)
-	{
-		return timeout > 0 ? execute("setex", key, timeout, val) : execute("set", key, val);
-	}
-	int hset(const string& key, const string& filed, const string& val)
-	{
-		return execute("hset", key, filed, val);
-	}
+			return true;
+		}
+		int refresh(bool force = false)
+		{
+			string msg;
+			int cnt = 0;
+			long long now = Socket::GetTime();
+			long long last = utime.load();
 
-public:
-	int pop(const string& key, string& val)
-	{
-		return lpop(key, val);
-	}
-	int lpop(const string& key, string& val)
-	{
-		vector<string> vec;
+			if (primary == NULL) return FAIL;
 
-		if (execute(vec, "lpop", key) <= 0) return code;
+			if (force)
+			{
+				utime = now;
+			}
+			else if (last + REPLICA_REFRESH > now || !utime.compare_exchange_strong(last, now))
+			{
+				return 0;
+			}
 
-		val = vec[0];
+			map<string, int> lags;
 
-		return code;
-	}
-	int rpop(const string& key, string& val)
-	{
-		vector<string> vec;
+			if (instance(primary)->getValue(msg, "info", "replication") > 0)
+			{
+				stringstream ss(msg);
+				string line;
 
-		if (execute(vec, "rpop", key) <= 0) return code;
+				while (getline(ss, line))
+				{
+					if (line.compare(0, 5, "slave") || line.find(':') == string::npos) continue;
 
-		val = vec[0];
+					string ip;
+					string state;
+					int lag = 0;
+					int port = 0;
+					stringstream tmp(line.substr(line.find(':') + 1));
 
-		return code;
-	}
-	int push(const string& key, const string& val)
-	{
-		return rpush(key, val);
-	}
-	int lpush(const string& key, const string& val)
-	{
-		return execute("lpush", key, val);
-	}
-	int rpush(const string& key, const string& val)
-	{
-		return execute("rpush", key, val);
-	}
-	int range(vector<string>& vec, const string& key, int start, int end)
-	{
-		return execute(vec, "lrange", key, start, end);
-	}
-	int lrange(vector<string>& vec, const string& key, int start, int end)
-	{
-		return execute(vec, "lrange", key, start, end);
-	}
+					for (string item; getline(tmp, item, ','); )
+					{
+						size_t pos = item.find('=');
 
-public:
-	int zrem(const string& key, const string& filed)
-	{
-		return execute("zrem", key, filed);
-	}
-	int zadd(const string& key, const string& filed, int score)
-	{
-		return execute("zadd", key, score, filed);
-	}
-	int zrange(vector<string>& vec, const string& key, int start, int end, bool withscore = false)
-	{
-		return withscore ? execute(vec, "zrange", key, start, end, "withscores") : execute(vec, "zrange", key, start, end);
-	}
+						if (pos == string::npos) continue;
 
-protected:
-	typedef map<shared_ptr<RedisConnect>, time_t> ConnectMap;
+						string key = item.substr(0, pos);
+						string val = item.substr(pos + 1);
 
-	static Mutex* GetMutex()
-	{
-		static Mutex mtx;
-		return &mtx;
-	}
-	static RedisConnect* GetTemplate()
-	{
-		static RedisConnect redis;
-		return &redis;
-	}
-	static ConnectMap* GetConnectMap()
-	{
-		static ConnectMap connmap;
-		return &connmap;
-	}
+						if (key == "ip") ip = val;
+						else if (key == "port") port = atoi(val.c_str());
+						else if (key == "lag") lag = atoi(val.c_str());
+						else if (key == "state") state = val;
+					}
 
-public:
-	static bool CanUse()
-	{
-		static RedisConnect* temp = GetTemplate();
-		return temp->port > 0;
-	}
-	static shared_ptr<RedisConnect> Instance()
-	{
-		static Mutex& mtx = *GetMutex();
-		static RedisConnect& temp = *GetTemplate();
-		static map<shared_ptr<RedisConnect>, time_t>& datmap = *GetConnectMap();
+					if (ip.empty() || port <= 0) continue;
 
-		time_t now = time(NULL);
-		shared_ptr<RedisConnect> redis;
+					if (state != "online") lag = INT_MAX;
 
-		if (now > 0)
-		{
-			Locker lk(mtx);
+					lags[ip + ":" + to_string(port)] = lag;
+
+					add(ip, port);
+				}
+			}
+
+			if (percentile.load(memory_order_relaxed) > 0) estimate();
 
-			for (auto item : datmap)
+			const vector<Node*>* vec = replicas.load();
+
+			for (Node* node : *vec)
 			{
-				if (item.first.use_count() == 2)
-				{
-					redis = item.first;
+				Command cmd;
+				auto it = lags.find(node->name);
 
-					if (item.second + 60 > now) return redis;
+				cmd.add("ping");
 
-					datmap.erase(item.first);
+				bool usable = execute(node, cmd) > 0;
 
-					break;
-				}
+				if (it != lags.end() && it->second > maxlag) usable = false;
+
+				node->usable.store(usable);
+
+				if (usable) cnt++;
 			}
-		}
 
-		auto get = [&](){
-			if (redis)
+			return cnt;
+		}
+		void setHedge(int percentile, int budget = 5)
+		{
+			this->budget.store(budget, memory_order_relaxed);
+			this->percentile.store(percentile < 100 ? percentile : 99, memory_order_relaxed);
+		}
+		long long getHedgeDelay() const
+		{
+			return delay.load();
+		}
+		long long getHedgeCount() const
+		{
+			return hedged.load();
+		}
+		long long getHedgeWinCount() const
+		{
+			return won.load();
+		}
+		shared_ptr<RedisConnect> instance(bool readonly)
+		{
+			return instance(readonly ? select() : primary);
+		}
+		int execute(Command& cmd)
+		{
+			if (primary == NULL)
 			{
-				if (redis->ping() > 0 || redis->reconnect()) return true;
+				cmd.reset();
+				cmd.setResult(NOTFOUND);
+
+				return NOTFOUND;
 			}
-			else
+
+			bool readonly = IsReadOnly(cmd);
+			Node* node = readonly ? select() : primary;
+
+			int res = execute(node, cmd, readonly);
+
+			if (node == primary) return res;
+
+			if (res == TIMEOUT || res == NETERR || res == NETCLOSE || res == SYSBUSY || (res == FAIL && (cmd.msg.compare(0, 7, "LOADING") == 0 || cmd.msg.compare(0, 10, "MASTERDOWN") == 0)))
 			{
-				redis = make_shared<RedisConnect>();
+				node->usable.store(false);
 
-				if (redis->connect(temp.host, temp.port, temp.timeout, temp.memsz))
-				{
-					if (redis->auth(temp.pwd)) return true;
-				}
+				return execute(primary, cmd);
 			}
 
-			return false;
-		};
+			return res;
+		}
+	public:
+		int hget(const string& key, const string& filed, string& val)
+		{
+			Command cmd;
+
+			cmd.add("hget", key, filed);
 
-		if (get())
+			if (execute(cmd) > 0 && cmd.getDataSize() > 0) val = cmd.get(0);
+
+			return cmd.getErrorCode();
+		}
+		int lrange(vector<string>& vec, const string& key, int start, int end)
 		{
-			Locker lk(mtx);
+			Command cmd;
+
+			cmd.add("lrange", key, start, end);
+
+			if (execute(cmd) > 0) vec = cmd.getDataList();
+
+			return cmd.getErrorCode();
+		}
+	};
+
+public:
+	static string GetErrorString(int code)
+	{
+		switch (code)
+		{
+		case SYSERR: return "system error";
+		case SYSBUSY: return "connection pool busy";
+		case NETERR: return "network error";
+		case DATAERR: return "protocol error";
+		case TIMEOUT: return "response timeout";
+		case NOTFOUND: return "element not found";
+		case PARAMERR: return "parameter error";
+		case NETCLOSE: return "network closed";
+		}
+
+		return "unknown error";
+	}
+	static const char* GetHashTag(const char* key, int& len)
+	{
+		const char* head = (const char*)(memchr(key, '{', len));
+
+		if (head == NULL) return key;
+
+		const char* tail = (const char*)(memchr(head + 1, '}', key + len - head - 1));
+
+		if (tail == NULL || tail == head + 1) return key;
+
+		len = tail - head - 1;
+
+		return head + 1;
+	}
+	static bool CanUse()
+	{
+		static RedisConnect* temp = GetTemplate();
+		return temp->port > 0;
+	}
+	static shared_ptr<RedisConnect> Instance()
+	{
+		static ConnectPool& pool = *GetConnectPool();
+		static thread_local RedisConnect* last = NULL;
+		static thread_local size_t shard = hash<thread::id>()(this_thread::get_id());
+
+		RedisConnect* redis = last;
 
-			if (datmap.size() < POOL_MAXLEN) datmap.insert(pair<shared_ptr<RedisConnect>, time_t>(redis, now));
+		if (redis && redis->acquire())
+		{
+			if (!redis->sock.isClosed()) return pool.instance(redis);
+
+			redis->release(false);
 		}
 
-		return redis;
+		if ((redis = pool.acquire(shard)) == NULL) return pool.instance(NULL);
+
+		last = redis;
+
+		return pool.instance(redis);
 	}
-	static void Setup(const string& host, int port, const string& pwd = "", int timeout = 3, int memsz = 1024 * 1024)
+	static void Setup(const string& host, int port, const string& pwd = "", double timeout = 3, int memsz = BUFFER_MAXSZ, bool uring = false)
 	{
 #ifndef _MSC_VER
 		signal(SIGPIPE, SIG_IGN);
@@ -868,8 +5464,67 @@ public:
 		redis->pwd = pwd;
 		redis->host = host;
 		redis->port = port;
+		redis->uring = uring;
 		redis->memsz = memsz;
-		redis->timeout = timeout;
+		redis->timeout = (int)(timeout * 1000 + 0.5);
+
+		if (!GetConnectPool()->inited()) GetConnectPool()->init(POOL_MAXLEN, 0, redis->timeout);
+	}
+	static void SetupProtocol(int proto)
+	{
+		GetTemplate()->proto = proto;
+	}
+	static void SetupPool(int maxlen, int minidle = 0, int maxwait = 0)
+	{
+		ConnectPool* pool = GetConnectPool();
+
+		pool->init(maxlen, minidle, maxwait);
+
+		if (CanUse())
+		{
+			vector<shared_ptr<RedisConnect>> vec;
+
+			while ((int)(vec.size()) < pool->getMinIdle()) vec.push_back(Instance());
+		}
+	}
+	static void SetupMaintain(int interval = 10, int idletime = 300)
+	{
+		GetConnectPool()->start(interval, idletime);
+	}
+	static bool SetupCluster(const string& host, int port, const string& pwd = "", double timeout = 3, int memsz = BUFFER_MAXSZ, int maxlen = POOL_MAXLEN)
+	{
+		return GetCluster()->init(host, port, pwd, timeout, memsz, maxlen);
+	}
+	static Cluster* GetCluster()
+	{
+		static Cluster cluster;
+		return &cluster;
+	}
+	static ReplicaSet* GetReplicaSet()
+	{
+		static ReplicaSet replica;
+		return &replica;
+	}
+	static bool SetupNearCache(long long maxmem, const vector<string>& prefixes = vector<string>())
+	{
+		return GetNearCache()->init(GetTemplate(), maxmem, prefixes);
+	}
+	static NearCache* GetNearCache()
+	{
+		static NearCache cache;
+		return &cache;
+	}
+	static ShardGroup* GetShardGroup(const string& name = "")
+	{
+		static Mutex mtx;
+		static map<string, unique_ptr<ShardGroup>> groups;
+
+		Locker lk(mtx);
+		unique_ptr<ShardGroup>& group = groups[name];
+
+		if (!group) group.reset(new ShardGroup());
+
+		return group.get();
 	}
 };
 ///////////////////////////////////////////////////////////////
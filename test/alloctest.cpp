@@ -0,0 +1,73 @@
+#include <atomic>
+
+#include "redisconnect.h"
+
+static atomic<long long> allocs(0);
+
+void* operator new(size_t size)
+{
+	allocs++;
+
+	if (void* ptr = malloc(size ? size : 1)) return ptr;
+
+	throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+	free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+	free(ptr);
+}
+
+int main(int argc, char** argv)
+{
+	const char* host = argc > 1 ? argv[1] : "127.0.0.1";
+	int port = argc > 2 ? atoi(argv[2]) : 6379;
+	int count = 10000;
+
+	RedisConnect::Setup(host, port);
+
+	shared_ptr<RedisConnect> redis = RedisConnect::Instance();
+
+	if (redis->ping() < 0)
+	{
+		printf("REDIS[%s][%d]连接失败\n", host, port);
+
+		return -1;
+	}
+
+	string out;
+	string key = "alloctest:key";
+	string num = "alloctest:num";
+	string hash = "alloctest:hash";
+	string val(100, 'v');
+
+	auto run = [&](){
+		redis->set(key, val);
+		redis->get(key, out);
+		redis->set(key, val, 60);
+		redis->incr(num, 3);
+		redis->decr(num, 3);
+		redis->ping();
+		redis->hset(hash, "field", val);
+		redis->hget(hash, "field", out);
+	};
+
+	for (int i = 0; i < 10; i++) run();
+
+	long long start = allocs.load();
+
+	for (int i = 0; i < count; i++) run();
+
+	long long res = allocs.load() - start;
+
+	redis->execute("del", key, num, hash);
+
+	printf("%d次迭代共分配%lld次内存\n", count, res);
+
+	return res == 0 ? 0 : 1;
+}
@@ -0,0 +1,88 @@
+#include "redisconnect.h"
+
+class Parser : public RedisConnect::Command
+{
+public:
+	using Command::parse;
+	using Command::reset;
+};
+
+static int bench(const char* name, const string& msg, int cnt)
+{
+	Parser parser;
+	int times = (int)(2000000000LL / msg.length()) + 1;
+
+	if (times > 200000) times = 200000;
+
+	for (int i = 0; i < 10; i++)
+	{
+		parser.reset();
+
+		if (parser.parse(msg.c_str(), msg.length()) <= 0 || parser.getDataSize() != cnt)
+		{
+			printf("%s解析失败\n", name);
+
+			return -1;
+		}
+	}
+
+	auto start = chrono::steady_clock::now();
+
+	for (int i = 0; i < times; i++)
+	{
+		parser.reset();
+		parser.parse(msg.c_str(), msg.length());
+	}
+
+	double sec = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+	printf("%-20s %8.2f GB/s %8.1f M elem/s\n", name, msg.length() * (double)times / sec / 1e9, (double)cnt * times / sec / 1e6);
+
+	return 0;
+}
+
+static int check(const char* name, const string& msg, int code)
+{
+	Parser parser;
+
+	parser.reset();
+
+	int res = parser.parse(msg.c_str(), msg.length());
+
+	printf("%-20s 期望[%d]结果[%d]\n", name, code, res);
+
+	return res == code ? 0 : -1;
+}
+
+static string bulk(int cnt, int len)
+{
+	string val(len, 'v');
+	string msg = "*" + to_string(cnt) + "\r\n";
+
+	for (int i = 0; i < cnt; i++) msg += "$" + to_string(len) + "\r\n" + val + "\r\n";
+
+	return msg;
+}
+
+static string integer(int cnt)
+{
+	string msg = "*" + to_string(cnt) + "\r\n";
+
+	for (int i = 0; i < cnt; i++) msg += ":" + to_string(1234567890123LL + i) + "\r\n";
+
+	return msg;
+}
+
+int main()
+{
+	if (check("$2147483647 bulk", "$2147483647\r\nvalue\r\n", RedisConnect::DATAERR) < 0) return 1;
+	if (check("$2147483646 bulk", "$2147483646\r\nvalue\r\n", RedisConnect::DATAERR) < 0) return 1;
+
+	if (bench("1000 x 8B bulk", bulk(1000, 8), 1000) < 0) return 1;
+	if (bench("1000 x 64B bulk", bulk(1000, 64), 1000) < 0) return 1;
+	if (bench("10000 x 512B bulk", bulk(10000, 512), 10000) < 0) return 1;
+	if (bench("100 x 64KB bulk", bulk(100, 65536), 100) < 0) return 1;
+	if (bench("1000 x integer", integer(1000), 1000) < 0) return 1;
+
+	return 0;
+}
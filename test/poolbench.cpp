@@ -0,0 +1,63 @@
+#include <atomic>
+#include <thread>
+
+#include "redisconnect.h"
+
+static double bench(int threads, int count)
+{
+	vector<thread> vec;
+	atomic<long long> fails(0);
+	long long start = RedisConnect::Socket::GetTime();
+
+	for (int i = 0; i < threads; i++)
+	{
+		vec.emplace_back([&](){
+			for (int j = 0; j < count; j++)
+			{
+				shared_ptr<RedisConnect> redis = RedisConnect::Instance();
+
+				if (!redis) fails++;
+			}
+		});
+	}
+
+	for (auto& item : vec) item.join();
+
+	long long cost = RedisConnect::Socket::GetTime() - start;
+	double res = cost * 1000000.0 / ((long long)threads * count);
+
+	printf("线程数[%d]借还次数[%lld]耗时[%lldms]单次[%.0fns]失败[%lld]\n", threads, (long long)threads * count, cost, res, fails.load());
+
+	return fails.load() > 0 ? -1 : res;
+}
+
+int main(int argc, char** argv)
+{
+	int threads = argc > 1 ? atoi(argv[1]) : 64;
+	const char* host = argc > 2 ? argv[2] : "127.0.0.1";
+	int port = argc > 3 ? atoi(argv[3]) : 6379;
+	int count = 20000;
+
+	RedisConnect::Setup(host, port);
+
+	vector<shared_ptr<RedisConnect>> vec;
+
+	for (int i = 0; i < RedisConnect::POOL_MAXLEN; i++)
+	{
+		vec.push_back(RedisConnect::Instance());
+
+		if (!vec.back())
+		{
+			printf("REDIS[%s][%d]连接失败\n", host, port);
+
+			return -1;
+		}
+	}
+
+	vec.clear();
+
+	if (bench(1, count) < 0) return 1;
+	if (bench(threads, count) < 0) return 1;
+
+	return 0;
+}
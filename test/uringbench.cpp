@@ -0,0 +1,122 @@
+#include <atomic>
+#include <cstdarg>
+#include <dlfcn.h>
+
+#include "redisconnect.h"
+
+static atomic<long long> calls(0);
+
+extern "C"
+{
+	ssize_t writev(int fd, const struct iovec* vec, int cnt)
+	{
+		static auto func = (ssize_t(*)(int, const struct iovec*, int))dlsym(RTLD_NEXT, "writev");
+
+		calls++;
+
+		return func(fd, vec, cnt);
+	}
+
+	ssize_t recv(int fd, void* buffer, size_t len, int flag)
+	{
+		static auto func = (ssize_t(*)(int, void*, size_t, int))dlsym(RTLD_NEXT, "recv");
+
+		calls++;
+
+		return func(fd, buffer, len, flag);
+	}
+
+	int poll(struct pollfd* fds, nfds_t cnt, int timeout)
+	{
+		static auto func = (int(*)(struct pollfd*, nfds_t, int))dlsym(RTLD_NEXT, "poll");
+
+		calls++;
+
+		return func(fds, cnt, timeout);
+	}
+
+	long syscall(long num, ...)
+	{
+		static auto func = (long(*)(long, ...))dlsym(RTLD_NEXT, "syscall");
+
+		long arg[6];
+		va_list ap;
+
+		va_start(ap, num);
+
+		for (int i = 0; i < 6; i++) arg[i] = va_arg(ap, long);
+
+		va_end(ap);
+
+#ifdef REDIS_CONNECT_URING
+		if (num == __NR_io_uring_enter) calls++;
+#endif
+
+		return func(num, arg[0], arg[1], arg[2], arg[3], arg[4], arg[5]);
+	}
+}
+
+static int bench(const char* host, int port, bool uring, int count, int vsz)
+{
+	string val(vsz, 'x');
+	string key = "uringbench:key";
+	string out;
+	RedisConnect redis;
+
+	redis.setUring(uring);
+
+	if (!redis.connect(host, port))
+	{
+		printf("REDIS[%s][%d]连接失败\n", host, port);
+
+		return -1;
+	}
+
+	redis.set(key, val);
+
+	long long start = calls.load();
+	long long time = RedisConnect::Socket::GetTime();
+
+	for (int i = 0; i < count; i++)
+	{
+		if (redis.get(key, out) <= 0 || out.length() != val.length())
+		{
+			printf("GET失败[%d]\n", redis.getErrorCode());
+
+			return -1;
+		}
+	}
+
+	time = RedisConnect::Socket::GetTime() - time;
+
+	double ops = count * 1000.0 / (time > 0 ? time : 1);
+	double cnt = (calls.load() - start) / (double)count;
+
+	RedisConnect::Pipeline pipe;
+
+	for (int i = 0; i < 500; i++) pipe.add("get", key);
+
+	start = calls.load();
+
+	int res = redis.execute(pipe);
+
+	printf("传输[%s]数据长度[%d]每秒操作[%.0f]单次系统调用[%.2f]管道500条命令结果[%d]系统调用[%lld]\n", redis.isUring() ? "io_uring" : "socket", vsz, ops, cnt, res, calls.load() - start);
+
+	redis.del(key);
+
+	return res > 0 ? 0 : -1;
+}
+
+int main(int argc, char** argv)
+{
+	const char* host = argc > 1 ? argv[1] : "127.0.0.1";
+	int port = argc > 2 ? atoi(argv[2]) : 6379;
+
+	for (int vsz : {10, 100000})
+	{
+		if (bench(host, port, false, 20000, vsz) < 0) return 1;
+		if (bench(host, port, true, 20000, vsz) < 0) return 1;
+	}
+
+	return 0;
+}